@@ -0,0 +1,299 @@
+/**
+ * ARC implementation
+ */
+#include <algorithm>
+
+#include "buffer/arc_replacer.h"
+#include "page/page.h"
+
+namespace cmudb
+{
+
+template <>
+page_id_t ARCReplacer<Page *>::GetKey(Page *const &value)
+{
+    return value->GetPageId();
+}
+
+template <>
+page_id_t ARCReplacer<int>::GetKey(const int &value)
+{
+    return value;
+}
+
+template <typename T>
+ARCReplacer<T>::ARCReplacer(size_t capacity, size_t correlation_period)
+    : capacity_(capacity), correlation_period_(correlation_period),
+      access_count_(0), target_t1_size_(0), size_(0) {}
+
+template <typename T>
+ARCReplacer<T>::~ARCReplacer() {}
+
+template <typename T>
+void ARCReplacer<T>::MoveTo(page_id_t key, Entry &entry, ListType list)
+{
+    lists_[entry.list].erase(entry.pos);
+    lists_[list].push_front(key);
+    entry.list = list;
+    entry.pos = lists_[list].begin();
+}
+
+template <typename T>
+void ARCReplacer<T>::TrimGhosts()
+{
+    while (lists_[T1].size() + lists_[B1].size() > capacity_ &&
+           !lists_[B1].empty())
+    {
+        entries_.erase(lists_[B1].back());
+        lists_[B1].pop_back();
+    }
+    while (lists_[T1].size() + lists_[T2].size() + lists_[B1].size() +
+                   lists_[B2].size() >
+               2 * capacity_ &&
+           !lists_[B2].empty())
+    {
+        entries_.erase(lists_[B2].back());
+        lists_[B2].pop_back();
+    }
+}
+
+/*
+ * A resident page moves to T2, unless it is in T1 and the access is
+ * correlated with the previous one. A page coming back from a ghost list
+ * moves to T2 and shifts the target size of T1 towards the list it was
+ * evicted from, any other page enters T1
+ */
+template <typename T>
+typename ARCReplacer<T>::Entry &ARCReplacer<T>::Access(const T &value)
+{
+    page_id_t key = GetKey(value);
+    auto it = entries_.find(key);
+    if (it == entries_.end())
+    {
+        lists_[T1].push_front(key);
+        Entry &entry = entries_[key];
+        entry.list = T1;
+        entry.pos = lists_[T1].begin();
+        entry.value = value;
+        entry.evictable = false;
+        entry.last_access = access_count_++;
+        TrimGhosts();
+        return entry;
+    }
+    Entry &entry = it->second;
+    bool correlated = entry.list == T1 &&
+                      access_count_ - entry.last_access <= correlation_period_;
+    entry.last_access = access_count_++;
+    size_t b1 = lists_[B1].size(), b2 = lists_[B2].size();
+    if (entry.list == B1)
+        target_t1_size_ =
+            std::min(capacity_, target_t1_size_ + std::max(b2 / b1, size_t(1)));
+    else if (entry.list == B2)
+        target_t1_size_ -=
+            std::min(target_t1_size_, std::max(b1 / b2, size_t(1)));
+    if (entry.evictable)
+        size_--;
+    entry.evictable = false;
+    entry.value = value;
+    MoveTo(key, entry, correlated ? T1 : T2);
+    return entry;
+}
+
+template <typename T>
+void ARCReplacer<T>::RecordAccess(const T &value)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    Access(value);
+}
+
+/*
+ * Make value evictable. A value that was never accessed counts Insert as its
+ * first access
+ */
+template <typename T>
+void ARCReplacer<T>::Insert(const T &value)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = entries_.find(GetKey(value));
+    Entry &entry = (it == entries_.end() || it->second.list == B1 ||
+                    it->second.list == B2)
+                       ? Access(value)
+                       : it->second;
+    if (!entry.evictable)
+        size_++;
+    entry.evictable = true;
+}
+
+template <typename T>
+typename ARCReplacer<T>::Entry *
+ARCReplacer<T>::FindVictim(ListType list, page_id_t &key,
+                           const std::function<bool(const T &)> &can_evict)
+{
+    for (auto it = lists_[list].rbegin(); it != lists_[list].rend(); ++it)
+    {
+        Entry &entry = entries_[*it];
+        if (entry.evictable && (!can_evict || can_evict(entry.value)))
+        {
+            key = *it;
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T>
+bool ARCReplacer<T>::Victim(T &value)
+{
+    return Victim(value, nullptr);
+}
+
+/*
+ * Evict the least recently used evictable page of T1 if T1 is above its
+ * target size, otherwise of T2 (falling back to the other list when the
+ * preferred one has only pinned pages). Pages rejected by can_evict (if not
+ * empty) are passed over and stay resident. The page id is remembered in
+ * the matching ghost list. Return false if nothing is evictable
+ */
+template <typename T>
+bool ARCReplacer<T>::Victim(T &value,
+                            const std::function<bool(const T &)> &can_evict)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    if (size_ == 0)
+        return false;
+    bool from_t1 = !lists_[T1].empty() &&
+                   (lists_[T1].size() > target_t1_size_ || lists_[T2].empty());
+    page_id_t key;
+    Entry *entry = FindVictim(from_t1 ? T1 : T2, key, can_evict);
+    if (entry == nullptr)
+    {
+        from_t1 = !from_t1;
+        entry = FindVictim(from_t1 ? T1 : T2, key, can_evict);
+    }
+    if (entry == nullptr)
+        return false;
+    value = entry->value;
+    entry->evictable = false;
+    size_--;
+    MoveTo(key, *entry, from_t1 ? B1 : B2);
+    TrimGhosts();
+    return true;
+}
+
+/*
+ * Like Victim, the page id of value is remembered in the ghost list that
+ * matches its list
+ */
+template <typename T>
+bool ARCReplacer<T>::Evict(const T &value)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    page_id_t key = GetKey(value);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || !it->second.evictable)
+        return false;
+    Entry &entry = it->second;
+    entry.evictable = false;
+    size_--;
+    MoveTo(key, entry, entry.list == T1 ? B1 : B2);
+    TrimGhosts();
+    return true;
+}
+
+/*
+ * Make value not evictable. If value was evictable return true, otherwise
+ * return false
+ */
+template <typename T>
+bool ARCReplacer<T>::Erase(const T &value)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = entries_.find(GetKey(value));
+    if (it == entries_.end() || !it->second.evictable)
+        return false;
+    it->second.evictable = false;
+    size_--;
+    return true;
+}
+
+/*
+ * Forget value, it does not leave a ghost behind. A ghost it left earlier is
+ * forgotten too
+ */
+template <typename T>
+void ARCReplacer<T>::Remove(const T &value)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = entries_.find(GetKey(value));
+    if (it == entries_.end())
+        return;
+    if (it->second.evictable)
+        size_--;
+    lists_[it->second.list].erase(it->second.pos);
+    entries_.erase(it);
+}
+
+/*
+ * Least recently used evictable pages of the list Victim currently prefers,
+ * then of the other one
+ */
+template <typename T>
+void ARCReplacer<T>::GetVictimCandidates(std::vector<T> &candidates,
+                                         size_t max_values)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    bool from_t1 = !lists_[T1].empty() &&
+                   (lists_[T1].size() > target_t1_size_ || lists_[T2].empty());
+    for (ListType list : {from_t1 ? T1 : T2, from_t1 ? T2 : T1})
+    {
+        for (auto it = lists_[list].rbegin();
+             it != lists_[list].rend() && max_values > 0; ++it)
+        {
+            Entry &entry = entries_[*it];
+            if (entry.evictable)
+            {
+                candidates.push_back(entry.value);
+                max_values--;
+            }
+        }
+    }
+}
+
+template <typename T>
+size_t ARCReplacer<T>::Size()
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    return size_;
+}
+
+/*
+ * The target size of T1 and the bound of the ghost lists follow the pool size
+ */
+template <typename T>
+void ARCReplacer<T>::SetCapacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    capacity_ = capacity;
+    target_t1_size_ = std::min(target_t1_size_, capacity_);
+    TrimGhosts();
+}
+
+template <typename T>
+size_t ARCReplacer<T>::GetTargetT1Size()
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    return target_t1_size_;
+}
+
+template <typename T>
+size_t ARCReplacer<T>::GetListSize(int list)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    return lists_[list].size();
+}
+
+template class ARCReplacer<Page *>;
+// test only
+template class ARCReplacer<int>;
+
+} // namespace cmudb
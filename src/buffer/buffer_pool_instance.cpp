@@ -0,0 +1,974 @@
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+#include "buffer/buffer_pool_instance.h"
+#include "common/logger.h"
+
+namespace cmudb
+{
+
+/*
+ * BufferPoolInstance Constructor
+ * When log_manager is nullptr, logging is disabled (for test purpose)
+ */
+BufferPoolInstance::BufferPoolInstance(size_t pool_size,
+                                       DiskManager *disk_manager,
+                                       LogManager *log_manager,
+                                       ReplacerType replacer_type)
+    : pool_size_(pool_size), max_frames_(pool_size * BUFFER_POOL_MAX_GROWTH),
+      frames_in_use_(pool_size), disk_manager_(disk_manager),
+      log_manager_(log_manager)
+{
+    // a consecutive memory space for this slice of the buffer pool, page size
+    // is decided by the database file. Frame descriptors are kept apart from
+    // the data so walking them does not touch the pages. Room is reserved
+    // for the pool to grow, frames above pool_size_ are retired (and have no
+    // huge pages behind them)
+    size_t page_size = disk_manager_->GetPageSize();
+    descriptor_arena_ = new FrameArena(max_frames_ * sizeof(Page));
+    data_arena_ = new FrameArena(max_frames_ * page_size,
+                                 BUFFER_POOL_HUGE_PAGES,
+                                 pool_size_ * page_size);
+    pages_ = reinterpret_cast<Page *>(descriptor_arena_->GetData());
+    // a frame is mapped twice while its dirty victim is written back
+    page_table_ = new LinearProbeHashTable<page_id_t, Page *>(
+        2 * max_frames_, INVALID_PAGE_ID);
+    switch (replacer_type)
+    {
+    case ReplacerType::CLOCK:
+        replacer_ = new ClockReplacer<Page *>(pool_size_, pages_);
+        break;
+    case ReplacerType::LRU_K:
+        replacer_ = new LRUKReplacer<Page *>(LRUK_REPLACER_K,
+                                             CORRELATED_REFERENCE_PERIOD);
+        break;
+    case ReplacerType::ARC:
+        replacer_ = new ARCReplacer<Page *>(pool_size_,
+                                            CORRELATED_REFERENCE_PERIOD);
+        break;
+    case ReplacerType::LRU:
+    default:
+        replacer_ = new LRUReplacer<Page *>;
+        break;
+    }
+    free_list_ = new std::list<Page *>;
+
+    // put all the pages into free list
+    for (size_t i = 0; i < max_frames_; ++i)
+    {
+        new (&pages_[i]) Page();
+        pages_[i].data_ = data_arena_->GetData() + i * page_size;
+        pages_[i].page_size_ = page_size;
+        pages_[i].pin_count_ = -1;
+        if (i < pool_size_)
+            free_list_->push_back(&pages_[i]);
+        else
+            pages_[i].retired_ = true;
+    }
+}
+
+BufferPoolInstance::~BufferPoolInstance()
+{
+    {
+        auto lock = LockLatch();
+        io_cv_.wait(lock, [this] { return async_reads_ == 0; });
+    }
+    for (size_t i = 0; i < max_frames_; ++i)
+        pages_[i].~Page();
+    delete descriptor_arena_;
+    delete data_arena_;
+    delete page_table_;
+    delete replacer_;
+    delete free_list_;
+}
+
+/*
+ * Look up page_id in page table. If its frame has I/O in flight, or is
+ * claimed (pin_count_ < 0) by someone who dropped latch_ to wait for a
+ * write-back, wait for that to finish and look again, since the frame may
+ * have been handed to another page meanwhile. Caller must hold latch_
+ * through lock
+ */
+bool BufferPoolInstance::FindPage(page_id_t page_id, Page *&pp,
+                                  std::unique_lock<std::mutex> &lock)
+{
+    while (page_table_->Find(page_id, pp))
+    {
+        if (!pp->io_in_progress_ && pp->pin_count_ >= 0)
+            return true;
+        io_cv_.wait(lock);
+    }
+    return false;
+}
+
+/*
+ * Pin a frame found by a lookup without latch_. The pin only succeeds while
+ * the frame is not claimed for another page (pin_count_ >= 0), and it is
+ * undone if the frame turns out to hold another page or to be in the middle
+ * of its I/O. Caller must not hold latch_
+ * The replacer is not told, its lock would serialize the hits again: the
+ * frame stays in it while pinned, GetVictimPage passes over it without
+ * disturbing its history since its pin_count_ cannot be claimed, and
+ * accessed_ (a CLOCK style reference bit) has the last unpin record the
+ * access. Concurrent hits count as one access
+ */
+bool BufferPoolInstance::TryPinPage(Page *pp, page_id_t page_id)
+{
+    int pin_count = pp->pin_count_;
+    do
+    {
+        if (pin_count < 0)
+            return false;
+    } while (!pp->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+    if (pp->page_id_ != page_id || pp->io_in_progress_)
+    {
+        auto guard = LockLatch();
+        // an eviction may have taken the frame out of the replacer while it
+        // was pinned here; it goes back only if it still holds a page and is
+        // not being retired
+        if (--pp->pin_count_ == 0 && pp->page_id_ != INVALID_PAGE_ID &&
+            size_t(pp - pages_) < pool_size_)
+            replacer_->Insert(pp);
+        // AbortIO may be waiting for the pin to go
+        io_cv_.notify_all();
+        return false;
+    }
+    pp->accessed_ = true;
+    return true;
+}
+
+/*
+ * Find a frame for a page that is about to become resident: always take from
+ * free list first, then ask the replacer for a victim. The frame is returned
+ * claimed (pin_count_ == -1), so that hits (and FindPage) leave it alone.
+ * A victim being cleaned by the background writer is waited for.
+ * Caller must hold latch_. Return nullptr if all the pages are pinned
+ */
+Page *BufferPoolInstance::GetVictimPage(std::unique_lock<std::mutex> &lock)
+{
+    Page *pp;
+    if (!free_list_->empty())
+    {
+        pp = free_list_->front();
+        free_list_->pop_front();
+        return pp;
+    }
+    if (ENABLE_LOGGING && log_manager_ != nullptr)
+    {
+        pp = GetLoggedVictimPage(lock);
+        if (pp != nullptr)
+            return pp;
+    }
+    // hits without latch_ leave their frame in the replacer, so the frames
+    // it offers may be pinned; the replacer is told to pass over them, as
+    // evicting them would drop the history of pages in use
+    auto claim = [](Page *const &candidate) {
+        int expected = 0;
+        return candidate->pin_count_.compare_exchange_strong(expected, -1);
+    };
+    if (!replacer_->Victim(pp, claim))
+        return nullptr;
+    while (pp->write_back_in_progress_)
+        io_cv_.wait(lock);
+    return pp;
+}
+
+/*
+ * Writing back a dirty victim whose LSN is not persistent yet would put a
+ * synchronous log flush on the miss. Among the next WAL_VICTIM_CANDIDATES
+ * victims, take the first clean one, else the first whose log records are
+ * already on disk; if there is none, GetVictimPage falls back to the
+ * replacer's choice and the write forces the log.
+ * Caller must hold latch_
+ */
+Page *BufferPoolInstance::GetLoggedVictimPage(
+    std::unique_lock<std::mutex> &lock)
+{
+    std::vector<Page *> candidates;
+    replacer_->GetVictimCandidates(candidates, WAL_VICTIM_CANDIDATES);
+    Page *victim = nullptr;
+    for (Page *pp : candidates)
+    {
+        if (pp->pin_count_ != 0 || pp->io_in_progress_)
+            continue;
+        if (!pp->is_dirty_ && !pp->write_back_in_progress_)
+        {
+            victim = pp;
+            break;
+        }
+        if (victim == nullptr && !NeedsLogForce(pp))
+            victim = pp;
+    }
+    int expected = 0;
+    if (victim == nullptr ||
+        !victim->pin_count_.compare_exchange_strong(expected, -1))
+        return nullptr;
+    // evicted like a victim of the replacer, so ARC keeps its ghost
+    replacer_->Evict(victim);
+    while (victim->write_back_in_progress_)
+        io_cv_.wait(lock);
+    return victim;
+}
+
+/*
+ * Miss of a caller confined to a buffer ring. Until the ring is full, its
+ * frames come from GetVictimPage; afterwards the oldest frame of the ring is
+ * recycled, unless it has been handed to another page or is pinned by
+ * someone else, in which case a frame from GetVictimPage takes its slot.
+ * Caller must hold latch_. Return nullptr if all the pages are pinned
+ */
+Page *BufferPoolInstance::GetRingVictimPage(BufferRing *ring,
+                                            page_id_t page_id,
+                                            std::unique_lock<std::mutex> &lock)
+{
+    Page *pp = nullptr;
+    size_t slot = ring->frames_.size();
+    if (slot == ring->capacity_)
+    {
+        slot = ring->next_;
+        ring->next_ = (ring->next_ + 1) % ring->capacity_;
+        pp = ring->frames_[slot];
+        int expected = 0;
+        if (pp->page_id_ == ring->page_ids_[slot] &&
+            pp->pin_count_.compare_exchange_strong(expected, -1))
+        {
+            replacer_->Remove(pp);
+            while (pp->write_back_in_progress_)
+                io_cv_.wait(lock);
+        }
+        else
+            pp = nullptr;
+    }
+    if (pp == nullptr)
+        pp = GetVictimPage(lock);
+    if (pp == nullptr)
+        return nullptr;
+    if (slot == ring->frames_.size())
+    {
+        ring->frames_.push_back(pp);
+        ring->page_ids_.push_back(page_id);
+    }
+    else
+    {
+        ring->frames_[slot] = pp;
+        ring->page_ids_[slot] = page_id;
+    }
+    return pp;
+}
+
+/*
+ * Take a frame for page_id, map page_id to it and pin it with I/O in flight,
+ * so the caller can drop latch_ while doing disk I/O on it. A clean victim is
+ * unmapped right away; a dirty one stays mapped (and anyone looking for it
+ * waits) until EvictVictim has written it back.
+ * Caller must hold latch_. Return nullptr if all the pages are pinned
+ */
+Page *BufferPoolInstance::InstallPage(page_id_t page_id,
+                                      page_id_t &victim_page_id,
+                                      bool &victim_dirty,
+                                      std::unique_lock<std::mutex> &lock,
+                                      BufferRing *ring)
+{
+    Page *pp = ring == nullptr ? GetVictimPage(lock)
+                               : GetRingVictimPage(ring, page_id, lock);
+    if (pp == nullptr)
+        return nullptr;
+    victim_page_id = pp->page_id_;
+    victim_dirty = pp->is_dirty_;
+    if (victim_page_id != INVALID_PAGE_ID && !victim_dirty)
+    {
+        counters_.Add(BufferPoolEvent::EVICTION);
+        page_table_->Remove(victim_page_id);
+    }
+    page_table_->Insert(page_id, pp);
+    pp->io_in_progress_ = true;
+    pp->page_id_ = page_id;
+    pp->is_dirty_ = false;
+    pp->accessed_ = false;
+    pp->pin_count_ = 1;
+    replacer_->RecordAccess(pp);
+    return pp;
+}
+
+/*
+ * Write back the dirty victim of InstallPage without holding latch_, then
+ * unmap it. If the write fails, the frame is handed back to the victim,
+ * still dirty, and InstallPage is undone: the page being installed is
+ * unmapped, so fetchers waiting on it miss and try again. Return false in
+ * that case. Return with latch_ released
+ */
+bool BufferPoolInstance::EvictVictim(Page *pp, page_id_t victim_page_id,
+                                     bool victim_dirty,
+                                     std::unique_lock<std::mutex> &lock)
+{
+    lock.unlock();
+    if (!victim_dirty)
+        return true;
+    bool ok = WritePageData(victim_page_id, pp);
+    lock.lock();
+    if (ok)
+    {
+        counters_.Add(BufferPoolEvent::EVICTION);
+        counters_.Add(BufferPoolEvent::DIRTY_EVICTION);
+        page_table_->Remove(victim_page_id);
+    }
+    else
+    {
+        // pins taken meanwhile by hits without latch_ are only transient
+        int expected = 1;
+        while (!pp->pin_count_.compare_exchange_strong(expected, -1))
+        {
+            expected = 1;
+            io_cv_.wait(lock);
+        }
+        page_table_->Remove(pp->page_id_);
+        // the access recorded for the page being installed goes, then the
+        // ghost the victim may have left, so it comes back as a new page
+        replacer_->Remove(pp);
+        pp->page_id_ = victim_page_id;
+        replacer_->Remove(pp);
+        pp->is_dirty_ = true;
+        pp->accessed_ = false;
+        pp->io_in_progress_ = false;
+        pp->pin_count_ = 0;
+        if (size_t(pp - pages_) < pool_size_)
+            replacer_->Insert(pp);
+    }
+    io_cv_.notify_all();
+    lock.unlock();
+    return ok;
+}
+
+/*
+ * Take latch_, timing the wait only when it is contended
+ */
+std::unique_lock<std::mutex> BufferPoolInstance::LockLatch()
+{
+    std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+    if (!lock.owns_lock())
+    {
+        auto start = std::chrono::steady_clock::now();
+        lock.lock();
+        counters_.latch_wait_.Record(std::chrono::steady_clock::now() - start);
+    }
+    return lock;
+}
+
+bool BufferPoolInstance::ReadPageData(page_id_t page_id, Page *pp)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool ok = disk_manager_->ReadPage(page_id, pp->data_);
+    counters_.read_latency_.Record(std::chrono::steady_clock::now() - start);
+    return ok;
+}
+
+bool BufferPoolInstance::WritePageData(page_id_t page_id, Page *pp)
+{
+    // a page ahead of the log on disk could not be recovered
+    if (!ForceLog(pp))
+        return false;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = disk_manager_->WritePage(page_id, pp->data_);
+    counters_.write_latency_.Record(std::chrono::steady_clock::now() - start);
+    return ok;
+}
+
+/*
+ * Called without latch_, with pp pinned or claimed and read latched (or
+ * otherwise safe from modification), so its LSN is stable
+ */
+bool BufferPoolInstance::ForceLog(Page *pp)
+{
+    if (!NeedsLogForce(pp))
+        return true;
+    if (!log_manager_->ForceFlush(pp->GetLSN()))
+    {
+        LOG_DEBUG("log not flushed up to page %d", pp->GetPageId());
+        return false;
+    }
+    counters_.Add(BufferPoolEvent::LOG_FORCE);
+    return true;
+}
+
+void BufferPoolInstance::FinishIO(Page *pp)
+{
+    auto guard = LockLatch();
+    pp->io_in_progress_ = false;
+    io_cv_.notify_all();
+}
+
+/*
+ * Unpinned in the same critical section, so that DeletePage of a caller
+ * who waited for the read does not find the frame still pinned
+ */
+void BufferPoolInstance::FinishBackgroundIO(Page *pp)
+{
+    auto guard = LockLatch();
+    pp->io_in_progress_ = false;
+    if (--pp->pin_count_ == 0 && size_t(pp - pages_) < pool_size_)
+        replacer_->Insert(pp);
+    io_cv_.notify_all();
+}
+
+/*
+ * Undo InstallPage after the read of page_id failed, instead of handing out
+ * a corrupt copy: the page is unmapped and its frame freed, so fetchers
+ * waiting on it miss and try the read themselves. Pins taken meanwhile by
+ * hits without latch_ are only transient, they are waited out.
+ * Caller must not hold latch_
+ */
+void BufferPoolInstance::AbortIO(Page *pp, page_id_t page_id)
+{
+    auto lock = LockLatch();
+    int expected = 1;
+    while (!pp->pin_count_.compare_exchange_strong(expected, -1))
+    {
+        expected = 1;
+        io_cv_.wait(lock);
+    }
+    replacer_->Remove(pp);
+    page_table_->Remove(page_id);
+    pp->page_id_ = INVALID_PAGE_ID;
+    pp->is_dirty_ = false;
+    pp->io_in_progress_ = false;
+    if (size_t(pp - pages_) < pool_size_)
+        free_list_->push_back(pp);
+    else
+        pp->retired_ = true;
+    io_cv_.notify_all();
+}
+
+/**
+ * 1. search hash table.
+ *  1.1 if exist, pin the page and return immediately
+ *  1.2 if no exist, find a replacement entry from either free list or lru
+ *      replacer. (NOTE: always find from free list first)
+ * 2. If the entry chosen for replacement is dirty, write it back to disk.
+ * 3. Delete the entry for the old page from the hash table and insert an
+ * entry for the new page.
+ * 4. Update page metadata, read page content from disk file and return page
+ * pointer
+ * Disk I/O of step 2 and 4 happens without holding latch_, concurrent
+ * fetchers of the same page wait on the frame in FindPage. A hit on a
+ * resident page takes no latch at all. A page that cannot be read (or fails
+ * its checksum) is not installed, nullptr is returned like when all the
+ * pages are pinned
+ */
+Page *BufferPoolInstance::FetchPage(page_id_t page_id, BufferRing *ring)
+{
+    Page *pp;
+    if (page_table_->Find(page_id, pp) && TryPinPage(pp, page_id))
+    {
+        counters_.Add(BufferPoolEvent::HIT);
+        return pp;
+    }
+    auto lock = LockLatch();
+    if (FindPage(page_id, pp, lock))
+    {
+        counters_.Add(BufferPoolEvent::HIT);
+        if (pp->pin_count_++ == 0)
+            replacer_->Erase(pp);
+        replacer_->RecordAccess(pp);
+        return pp;
+    }
+    counters_.Add(BufferPoolEvent::MISS);
+    page_id_t victim_page_id;
+    bool victim_dirty;
+    pp = InstallPage(page_id, victim_page_id, victim_dirty, lock, ring);
+    if (pp == nullptr ||
+        !EvictVictim(pp, victim_page_id, victim_dirty, lock))
+        return nullptr;
+    if (!ReadPageData(page_id, pp))
+    {
+        AbortIO(pp, page_id);
+        return nullptr;
+    }
+    FinishIO(pp);
+    return pp;
+}
+
+/*
+ * Hit-only version of FetchPage, for callers that would rather do something
+ * else than wait for a read. Return nullptr if the page is not resident or
+ * still being read
+ */
+Page *BufferPoolInstance::FetchResidentPage(page_id_t page_id)
+{
+    Page *pp;
+    if (page_table_->Find(page_id, pp) && TryPinPage(pp, page_id))
+    {
+        counters_.Add(BufferPoolEvent::HIT);
+        return pp;
+    }
+    return nullptr;
+}
+
+/*
+ * Read the page into a frame and leave it unpinned, where the next
+ * FetchPage finds it. Nothing is read if the page is already resident (or
+ * being read), so the replacer does not see an access for it.
+ * The read is asynchronous: the frame is pinned with I/O in flight, like
+ * during a miss, until the read completes on an I/O thread; meanwhile the
+ * caller goes on with the next hint.
+ * on_read runs on the I/O thread once the page is read, or right away if it
+ * is resident; it is skipped if the page is being read by someone else, or
+ * cannot be read
+ */
+void BufferPoolInstance::PrefetchPage(page_id_t page_id, BufferRing *ring,
+                                      std::function<void(Page *)> on_read)
+{
+    Page *pp;
+    bool resident = page_table_->Find(page_id, pp);
+    if (!resident)
+    {
+        auto lock = LockLatch();
+        resident = page_table_->Find(page_id, pp);
+        if (!resident)
+        {
+            page_id_t victim_page_id;
+            bool victim_dirty;
+            pp = InstallPage(page_id, victim_page_id, victim_dirty, lock,
+                             ring);
+            if (pp == nullptr)
+                return;
+            async_reads_++;
+            if (!EvictVictim(pp, victim_page_id, victim_dirty, lock))
+            {
+                auto guard = LockLatch();
+                async_reads_--;
+                io_cv_.notify_all();
+                return;
+            }
+            counters_.Add(BufferPoolEvent::PREFETCH);
+            ReadPageAsync(pp, page_id, std::move(on_read));
+            return;
+        }
+    }
+    if (on_read && TryPinPage(pp, page_id))
+    {
+        on_read(pp);
+        UnpinPage(page_id, false);
+    }
+}
+
+void BufferPoolInstance::ReadPageAsync(Page *pp, page_id_t page_id,
+                                       std::function<void(Page *)> on_read)
+{
+    auto start = std::chrono::steady_clock::now();
+    disk_manager_->ReadPageAsync(
+        page_id, pp->data_, [this, pp, page_id, start, on_read](bool ok) {
+            counters_.read_latency_.Record(std::chrono::steady_clock::now() -
+                                           start);
+            if (!ok)
+                AbortIO(pp, page_id);
+            else if (on_read)
+            {
+                FinishIO(pp);
+                on_read(pp);
+                UnpinPage(page_id, false);
+            }
+            else
+                FinishBackgroundIO(pp);
+            auto guard = LockLatch();
+            async_reads_--;
+            io_cv_.notify_all();
+        });
+}
+
+/*
+ * Implementation of unpin page
+ * if pin_count>0, decrement it and if it becomes zero, put it back to
+ * replacer if pin_count<=0 before this call, return false. is_dirty: set the
+ * dirty flag of this page
+ */
+bool BufferPoolInstance::UnpinPage(page_id_t page_id, bool is_dirty)
+{
+    Page *pp;
+    auto lock = LockLatch();
+    if (!FindPage(page_id, pp, lock) || pp->pin_count_ <= 0)
+        return false;
+    // a clean unpin must not hide an earlier modification
+    pp->is_dirty_ = pp->is_dirty_ || is_dirty;
+    // a frame the pool shrank away from waits for ReleaseFrames instead of
+    // being handed to another page
+    if (--pp->pin_count_ == 0 && size_t(pp - pages_) < pool_size_)
+    {
+        if (pp->accessed_.exchange(false))
+            replacer_->RecordAccess(pp);
+        replacer_->Insert(pp);
+    }
+    return true;
+}
+
+/*
+ * Used to flush a particular page of the buffer pool to disk. Should call the
+ * write_page method of the disk manager
+ * if page is not found in page table, return false
+ * The page is pinned for the duration of the write so latch_ can be released.
+ * If the write fails, the page is marked dirty again and false is returned
+ */
+bool BufferPoolInstance::FlushPage(page_id_t page_id)
+{
+    Page *pp;
+    auto lock = LockLatch();
+    if (!FindPage(page_id, pp, lock))
+        return false;
+    if (pp->pin_count_++ == 0)
+        replacer_->Erase(pp);
+    pp->is_dirty_ = false;
+    lock.unlock();
+    pp->RLatch();
+    bool ok = WritePageData(page_id, pp);
+    pp->RUnlatch();
+    counters_.Add(BufferPoolEvent::FLUSH);
+    lock.lock();
+    if (!ok)
+        pp->is_dirty_ = true;
+    if (--pp->pin_count_ == 0 && size_t(pp - pages_) < pool_size_)
+        replacer_->Insert(pp);
+    return ok;
+}
+
+/**
+ * If page is found within page table, remove this entry out of page table,
+ * reset page metadata and add it back to free list. If the page is found
+ * within page table, but pin_count != 0, return false. Deallocating the page
+ * on disk is left to BufferPoolManager.
+ */
+bool BufferPoolInstance::DeletePage(page_id_t page_id)
+{
+    Page *pp;
+    auto lock = LockLatch();
+    if (FindPage(page_id, pp, lock))
+    {
+        int expected = 0;
+        if (!pp->pin_count_.compare_exchange_strong(expected, -1))
+            return false;
+        while (pp->write_back_in_progress_)
+            io_cv_.wait(lock);
+        replacer_->Remove(pp);
+        page_table_->Remove(page_id);
+        pp->page_id_ = INVALID_PAGE_ID;
+        pp->is_dirty_ = false;
+        if (size_t(pp - pages_) < pool_size_)
+            free_list_->push_back(pp);
+        else
+            pp->retired_ = true;
+        // FindPage may be waiting for the claim to go
+        io_cv_.notify_all();
+    }
+    return true;
+}
+
+/*
+ * Used by the background writer: ask the replacer for the next pages to be
+ * evicted and write back the dirty unpinned ones, so that a later miss finds
+ * a clean victim. The page stays resident and usable while it is written
+ * (under its read latch, like FlushPage); only evicting it waits.
+ * The writes are asynchronous, all of them in flight at once; the read
+ * latch of a page is released on the I/O thread when its write is done,
+ * and the page is marked dirty again if the write failed.
+ * Return once every write has completed, with the number of writes that
+ * succeeded
+ */
+size_t BufferPoolInstance::WriteBackDirtyPages(size_t max_pages)
+{
+    std::vector<Page *> candidates;
+    replacer_->GetVictimCandidates(candidates, max_pages);
+    size_t written = 0;   // protected by latch_
+    size_t in_flight = 0; // protected by latch_
+    auto lock = LockLatch();
+    for (Page *pp : candidates)
+    {
+        if (pp->pin_count_ != 0 || !pp->is_dirty_ || pp->io_in_progress_ ||
+            pp->write_back_in_progress_)
+            continue;
+        page_id_t page_id = pp->page_id_;
+        // cleared first, so a modification made during the write marks the
+        // page dirty again
+        pp->is_dirty_ = false;
+        pp->write_back_in_progress_ = true;
+        in_flight++;
+        lock.unlock();
+        pp->RLatch();
+        if (!ForceLog(pp))
+        {
+            // left dirty, a later round or an eviction tries again
+            pp->RUnlatch();
+            lock.lock();
+            pp->is_dirty_ = true;
+            pp->write_back_in_progress_ = false;
+            in_flight--;
+            io_cv_.notify_all();
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        disk_manager_->WritePageAsync(
+            page_id, pp->data_,
+            [this, pp, start, &written, &in_flight](bool ok) {
+                counters_.write_latency_.Record(
+                    std::chrono::steady_clock::now() - start);
+                pp->RUnlatch();
+                auto guard = LockLatch();
+                if (ok)
+                    written++;
+                else
+                    pp->is_dirty_ = true;
+                pp->write_back_in_progress_ = false;
+                in_flight--;
+                io_cv_.notify_all();
+            });
+        lock.lock();
+    }
+    io_cv_.wait(lock, [&in_flight] { return in_flight == 0; });
+    counters_.Add(BufferPoolEvent::WRITE_BACK, written);
+    return written;
+}
+
+/*
+ * Dirty pages for a flush of the whole pool. Nothing is pinned, the flush
+ * pins a run of them at a time with PinDirtyPage
+ */
+void BufferPoolInstance::GetDirtyPageIds(std::vector<page_id_t> &page_ids)
+{
+    auto lock = LockLatch();
+    for (size_t i = 0; i < frames_in_use_; ++i)
+    {
+        Page *pp = &pages_[i];
+        if (pp->pin_count_ >= 0 && pp->is_dirty_ && !pp->io_in_progress_)
+            page_ids.push_back(pp->page_id_);
+    }
+}
+
+/*
+ * Hand a dirty page over to a flush. It is pinned so it stays resident
+ * while the caller writes it, and cleared first, like in FlushPage, so a
+ * modification made meanwhile is not lost. Return nullptr if the page is
+ * no longer resident or dirty
+ */
+Page *BufferPoolInstance::PinDirtyPage(page_id_t page_id)
+{
+    Page *pp;
+    auto lock = LockLatch();
+    if (!FindPage(page_id, pp, lock) || !pp->is_dirty_)
+        return nullptr;
+    if (pp->pin_count_++ == 0)
+        replacer_->Erase(pp);
+    pp->is_dirty_ = false;
+    counters_.Add(BufferPoolEvent::FLUSH);
+    return pp;
+}
+
+double BufferPoolInstance::GetDirtyRatio()
+{
+    auto guard = LockLatch();
+    if (frames_in_use_ == 0)
+        return 0;
+    size_t dirty = 0;
+    // frames waiting to be retired may still hold dirty pages, so they count
+    // on both sides
+    for (size_t i = 0; i < frames_in_use_; ++i)
+        if (pages_[i].is_dirty_)
+            dirty++;
+    return double(dirty) / frames_in_use_;
+}
+
+/*
+ * Snapshot of the pages worth keeping over a restart. The replacer knows
+ * the order of the evictable pages only, pinned pages are taken as hotter
+ */
+void BufferPoolInstance::GetResidentPages(std::vector<page_id_t> &page_ids)
+{
+    std::vector<Page *> candidates;
+    auto lock = LockLatch();
+    for (size_t i = 0; i < frames_in_use_; ++i)
+        if (pages_[i].pin_count_ > 0 && !pages_[i].io_in_progress_)
+            page_ids.push_back(pages_[i].page_id_);
+    replacer_->GetVictimCandidates(candidates, frames_in_use_);
+    for (auto it = candidates.rbegin(); it != candidates.rend(); ++it)
+        if ((*it)->pin_count_ == 0)
+            page_ids.push_back((*it)->page_id_);
+}
+
+/*
+ * Warm-up only fills free frames, so it never evicts a page that traffic
+ * brought in meanwhile. The frame is mapped before the page is read: a
+ * fetch of the page waits for the warm copy instead of reading its own, so
+ * it cannot be changed, written back and evicted before the warm copy
+ * shadows it
+ */
+Page *BufferPoolInstance::ClaimFreeFrame(page_id_t page_id, bool &full)
+{
+    Page *pp;
+    auto lock = LockLatch();
+    full = false;
+    if (page_table_->Find(page_id, pp))
+        return nullptr;
+    if (free_list_->empty())
+    {
+        full = true;
+        return nullptr;
+    }
+    page_id_t victim_page_id;
+    bool victim_dirty;
+    return InstallPage(page_id, victim_page_id, victim_dirty, lock, nullptr);
+}
+
+void BufferPoolInstance::WarmPage(Page *pp, page_id_t page_id,
+                                  const char *page_data)
+{
+    if (page_data == nullptr)
+    {
+        AbortIO(pp, page_id);
+        return;
+    }
+    memcpy(pp->data_, page_data, pp->page_size_);
+    counters_.Add(BufferPoolEvent::WARM_UP);
+    FinishBackgroundIO(pp);
+}
+
+/*
+ * Change the number of frames in use. Frames up to pool_size come back from
+ * retirement onto the free list (or simply stay in use if they were still
+ * waiting to be released); frames above it are left to ReleaseFrames.
+ * Return false if pool_size exceeds the room reserved at construction, or
+ * if no huge pages are left for the frames to grow into
+ */
+bool BufferPoolInstance::Resize(size_t pool_size)
+{
+    if (pool_size > max_frames_)
+        return false;
+    auto lock = LockLatch();
+    size_t page_size = disk_manager_->GetPageSize();
+    if (pool_size > pool_size_ &&
+        !data_arena_->Commit(pool_size_ * page_size,
+                             (pool_size - pool_size_) * page_size))
+        return false;
+    for (size_t i = pool_size_; i < pool_size; ++i)
+    {
+        if (pages_[i].retired_)
+        {
+            pages_[i].retired_ = false;
+            free_list_->push_back(&pages_[i]);
+        }
+        else if (pages_[i].pin_count_ == 0)
+        {
+            // kept out of the replacer by UnpinPage while it was to retire
+            replacer_->Insert(&pages_[i]);
+        }
+    }
+    pool_size_ = pool_size;
+    frames_in_use_ = std::max(frames_in_use_, pool_size);
+    replacer_->SetCapacity(pool_size);
+    return true;
+}
+
+/*
+ * Retire the frames above pool_size_: free ones are taken off the free list,
+ * unpinned ones are evicted like a victim (written back first if dirty),
+ * pinned ones are left for a later call. The memory of retired frames is
+ * handed back to the system. Return the number of frames left to release
+ */
+size_t BufferPoolInstance::ReleaseFrames()
+{
+    auto lock = LockLatch();
+    size_t pending = 0;
+    for (size_t i = pool_size_; i < frames_in_use_; ++i)
+    {
+        Page *pp = &pages_[i];
+        if (pp->retired_)
+            continue;
+        if (pp->page_id_ == INVALID_PAGE_ID)
+        {
+            // free frame
+            free_list_->remove(pp);
+        }
+        else
+        {
+            int expected = 0;
+            if (!pp->pin_count_.compare_exchange_strong(expected, -1))
+            {
+                pending++;
+                continue;
+            }
+            while (pp->write_back_in_progress_)
+                io_cv_.wait(lock);
+            replacer_->Remove(pp);
+            page_id_t page_id = pp->page_id_;
+            if (pp->is_dirty_)
+            {
+                // stays mapped so that fetchers wait for the write
+                pp->io_in_progress_ = true;
+                lock.unlock();
+                bool ok = WritePageData(page_id, pp);
+                lock.lock();
+                pp->io_in_progress_ = false;
+                io_cv_.notify_all();
+                if (!ok)
+                {
+                    // kept, still dirty, for a later call
+                    pp->pin_count_ = 0;
+                    pending++;
+                    continue;
+                }
+                counters_.Add(BufferPoolEvent::DIRTY_EVICTION);
+            }
+            counters_.Add(BufferPoolEvent::EVICTION);
+            page_table_->Remove(page_id);
+            pp->page_id_ = INVALID_PAGE_ID;
+            pp->is_dirty_ = false;
+        }
+        pp->retired_ = true;
+    }
+    // FindPage may be waiting for a claim that went with the frame
+    io_cv_.notify_all();
+    while (frames_in_use_ > pool_size_ && pages_[frames_in_use_ - 1].retired_)
+        frames_in_use_--;
+    // return memory of runs of retired frames, whole system pages only
+    size_t page_size = disk_manager_->GetPageSize();
+    for (size_t i = pool_size_; i < max_frames_;)
+    {
+        size_t end = i;
+        while (end < max_frames_ && pages_[end].retired_)
+            end++;
+        if (end > i)
+            data_arena_->Release(i * page_size, (end - i) * page_size);
+        i = end + 1;
+    }
+    return pending;
+}
+
+/**
+ * Choose a victim page either from free list or lru replacer(NOTE: always
+ * choose from free list first), update new page's metadata, zero out memory
+ * and add corresponding entry into page table. return nullptr if all the
+ * pages in this instance are pinned
+ */
+Page *BufferPoolInstance::NewPage(page_id_t page_id, BufferRing *ring)
+{
+    auto lock = LockLatch();
+    Page *pp;
+    if (FindPage(page_id, pp, lock))
+    {
+        // a copy of the page from before it was deallocated, brought in by
+        // warm-up, is taken over
+        if (pp->pin_count_++ == 0)
+            replacer_->Erase(pp);
+        replacer_->RecordAccess(pp);
+        pp->is_dirty_ = false;
+        lock.unlock();
+        pp->ResetMemory();
+        return pp;
+    }
+    page_id_t victim_page_id;
+    bool victim_dirty;
+    pp = InstallPage(page_id, victim_page_id, victim_dirty, lock, ring);
+    if (pp == nullptr ||
+        !EvictVictim(pp, victim_page_id, victim_dirty, lock))
+        return nullptr;
+    pp->ResetMemory();
+    FinishIO(pp);
+    return pp;
+}
+} // namespace cmudb
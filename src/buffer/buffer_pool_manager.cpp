@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
 #include "buffer/buffer_pool_manager.h"
 
 namespace cmudb
@@ -6,94 +10,135 @@ namespace cmudb
 /*
  * BufferPoolManager Constructor
  * When log_manager is nullptr, logging is disabled (for test purpose)
- * WARNING: Do Not Edit This Function
+ * pool_size frames are spread as evenly as possible over num_instances
+ * partitions, each of them evicting with a replacer of replacer_type
  */
 BufferPoolManager::BufferPoolManager(size_t pool_size,
                                      DiskManager *disk_manager,
-                                     LogManager *log_manager)
+                                     LogManager *log_manager,
+                                     size_t num_instances,
+                                     ReplacerType replacer_type)
     : pool_size_(pool_size), disk_manager_(disk_manager),
       log_manager_(log_manager)
 {
-    // a consecutive memory space for buffer pool
-    pages_ = new Page[pool_size_];
-    page_table_ = new ExtendibleHash<page_id_t, Page *>(BUCKET_SIZE);
-    replacer_ = new LRUReplacer<Page *>;
-    free_list_ = new std::list<Page *>;
-
-    // put all the pages into free list
-    for (size_t i = 0; i < pool_size_; ++i)
+    if (num_instances == 0)
+        num_instances = 1;
+    if (num_instances > pool_size_ && pool_size_ > 0)
+        num_instances = pool_size_;
+    for (size_t i = 0; i < num_instances; ++i)
     {
-        free_list_->push_back(&pages_[i]);
+        size_t instance_size = pool_size_ / num_instances +
+                               (i < pool_size_ % num_instances ? 1 : 0);
+        instances_.push_back(
+            new BufferPoolInstance(instance_size, disk_manager_, log_manager_,
+                                   replacer_type));
     }
 }
 
 /*
  * BufferPoolManager Deconstructor
- * WARNING: Do Not Edit This Function
  */
 BufferPoolManager::~BufferPoolManager()
 {
-    delete[] pages_;
-    delete page_table_;
-    delete replacer_;
-    delete free_list_;
+    StopBackgroundWriter();
+    StopResidentPageDumper();
+    warmup_running_ = false;
+    if (warmup_thread_ != nullptr)
+    {
+        warmup_thread_->join();
+        delete warmup_thread_;
+    }
+    {
+        std::lock_guard<std::mutex> guard(resize_latch_);
+        resize_running_ = false;
+    }
+    resize_cv_.notify_all();
+    if (resize_thread_ != nullptr)
+    {
+        resize_thread_->join();
+        delete resize_thread_;
+    }
+    {
+        std::lock_guard<std::mutex> guard(prefetch_latch_);
+        prefetch_running_ = false;
+    }
+    prefetch_cv_.notify_all();
+    if (prefetch_thread_ != nullptr)
+    {
+        prefetch_thread_->join();
+        delete prefetch_thread_;
+    }
+    for (auto instance : instances_)
+        delete instance;
 }
 
 /**
- * 1. search hash table.
- *  1.1 if exist, pin the page and return immediately
- *  1.2 if no exist, find a replacement entry from either free list or lru
- *      replacer. (NOTE: always find from free list first)
- * 2. If the entry chosen for replacement is dirty, write it back to disk.
- * 3. Delete the entry for the old page from the hash table and insert an
- * entry for the new page.
- * 4. Update page metadata, read page content from disk file and return page
- * pointer
- */
-Page *BufferPoolManager::FetchPage(page_id_t page_id)
-{
-    Page *pp;
+ * Fetch the requested page from the instance that owns it, reading it from
+ * disk if it is not resident (into a frame of the ring of strategy, if
+ * given). return nullptr if all the pages of that instance are pinned
+ */
+Page *BufferPoolManager::FetchPage(page_id_t page_id,
+                                   BufferAccessStrategy *strategy)
+{
     if (page_id == INVALID_PAGE_ID)
         return nullptr;
-    latch_.lock();
-    if (page_table_->Find(page_id, pp))
-    {
-        pp->pin_count_++;
-        latch_.unlock();
-        return pp;
-    }
-    else
+    return GetInstance(page_id)->FetchPage(page_id,
+                                           GetRing(page_id, strategy));
+}
+
+/*
+ * Like FetchPage, but return nullptr instead of reading the page from disk
+ * (or waiting for a read in flight)
+ */
+Page *BufferPoolManager::FetchResidentPage(page_id_t page_id)
+{
+    if (page_id == INVALID_PAGE_ID)
+        return nullptr;
+    return GetInstance(page_id)->FetchResidentPage(page_id);
+}
+
+/*
+ * Queue page_id for the prefetch thread and return right away. Hints are
+ * dropped while as many are queued as the pool has frames, since reading
+ * more would only evict pages prefetched earlier. The page is read into the
+ * ring of strategy, if given
+ */
+void BufferPoolManager::PrefetchPage(
+    page_id_t page_id, std::shared_ptr<BufferAccessStrategy> strategy,
+    std::function<void(Page *)> on_read)
+{
+    if (page_id == INVALID_PAGE_ID)
+        return;
+    std::lock_guard<std::mutex> guard(prefetch_latch_);
+    if (prefetch_queue_.size() >= pool_size_)
+        return;
+    prefetch_queue_.push_back(
+        PrefetchHint{page_id, std::move(strategy), std::move(on_read)});
+    if (prefetch_thread_ == nullptr)
     {
-        if (free_list_->size() > 0)
-        {
-            pp = free_list_->front();
-            free_list_->pop_front();
-        }
-        else if (replacer_->Victim(pp))
-        {
-            if (pp->pin_count_ > 0)
+        prefetch_running_ = true;
+        prefetch_thread_ = new std::thread([this] {
+            std::unique_lock<std::mutex> lock(prefetch_latch_);
+            while (true)
             {
-                latch_.unlock();
-                return nullptr;
+                prefetch_cv_.wait(lock, [this] {
+                    return !prefetch_running_ || !prefetch_queue_.empty();
+                });
+                if (!prefetch_running_)
+                    return;
+                PrefetchHint hint = std::move(prefetch_queue_.front());
+                prefetch_queue_.pop_front();
+                lock.unlock();
+                GetInstance(hint.page_id_)
+                    ->PrefetchPage(hint.page_id_,
+                                   GetRing(hint.page_id_, hint.strategy_.get()),
+                                   std::move(hint.on_read_));
+                hint = PrefetchHint();
+                lock.lock();
             }
-            if (pp->is_dirty_)
-            {
-                pp->WLatch();
-                disk_manager_->WritePage(pp->page_id_, pp->data_);
-                pp->WUnlatch();
-            }
-            page_table_->Remove(pp->page_id_);
-        }
-        page_table_->Insert(page_id, pp);
-        pp->page_id_ = page_id;
-        pp->pin_count_++;
-        pp->is_dirty_ = false;
-        pp->RLatch();
-        disk_manager_->ReadPage(pp->page_id_, pp->data_);
-        pp->RUnlatch();
-        latch_.unlock();
-        return pp;
+        });
     }
+    prefetch_cv_.notify_one();
 }
 
 /*
@@ -104,28 +149,9 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id)
  */
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty)
 {
-    Page *pp;
     if (page_id == INVALID_PAGE_ID)
         return false;
-    latch_.lock();
-    if (page_table_->Find(page_id, pp))
-    {
-        if (pp->pin_count_ <= 0)
-        {
-            latch_.unlock();
-            return false;
-        }
-        pp->pin_count_--;
-        pp->is_dirty_ = is_dirty;
-        if (pp->pin_count_ == 0)
-        {
-            replacer_->Insert(pp);
-        }
-        latch_.unlock();
-        return true;
-    }
-    latch_.unlock();
-    return false;
+    return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
 }
 
 /*
@@ -136,20 +162,87 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty)
  */
 bool BufferPoolManager::FlushPage(page_id_t page_id)
 {
-    Page *pp;
     if (page_id == INVALID_PAGE_ID)
         return false;
-    latch_.lock();
-    if (page_table_->Find(page_id, pp))
+    return GetInstance(page_id)->FlushPage(page_id);
+}
+
+/*
+ * Write back all the dirty pages as sequential I/O. Consecutive page ids live
+ * in different instances, so the dirty page ids of all of them are sorted
+ * together; every run of consecutive pages goes out in one write, and the
+ * file is synced once at the end.
+ * Only the pages of the run being written are pinned, so misses keep
+ * finding victims while a mostly dirty pool is flushed. Only the first page
+ * of a run is waited for; the others join it only if their read latch is
+ * free, so the flush never waits for a latch while holding another one. The
+ * pages of a run that cannot be written, or whose log records cannot be
+ * forced to disk, are marked dirty again; return the number of pages
+ * written
+ */
+size_t BufferPoolManager::FlushDirtyPages()
+{
+    std::vector<page_id_t> page_ids;
+    for (auto instance : instances_)
+        instance->GetDirtyPageIds(page_ids);
+    std::sort(page_ids.begin(), page_ids.end());
+
+    auto pin = [this](page_id_t page_id) {
+        return GetInstance(page_id)->PinDirtyPage(page_id);
+    };
+    std::vector<Page *> pages;
+    std::vector<const char *> run;
+    size_t written = 0;
+    size_t next = 0;
+    Page *pp = nullptr; // pinned, starts the next run
+    while (true)
     {
-        pp->WLatch();
-        disk_manager_->WritePage(pp->page_id_, pp->data_);
-        pp->WUnlatch();
-        latch_.unlock();
-        return true;
+        while (pp == nullptr && next < page_ids.size())
+            pp = pin(page_ids[next++]);
+        if (pp == nullptr)
+            break;
+        page_id_t first_page_id = pp->GetPageId();
+        pp->RLatch();
+        pages.assign(1, pp);
+        pp = nullptr;
+        while (next < page_ids.size() && pages.size() < FLUSH_WRITE_PAGES &&
+               page_ids[next] == first_page_id + page_id_t(pages.size()))
+        {
+            Page *np = pin(page_ids[next++]);
+            if (np == nullptr)
+                break;
+            if (!np->TryRLatch())
+            {
+                pp = np;
+                break;
+            }
+            pages.push_back(np);
+        }
+        run.clear();
+        Page *last_logged = pages.front();
+        for (Page *page : pages)
+        {
+            run.push_back(page->GetData());
+            if (page->GetLSN() > last_logged->GetLSN())
+                last_logged = page;
+        }
+        // one log force covers the whole run, which is skipped (and left
+        // dirty) if the log cannot be flushed
+        bool ok =
+            GetInstance(last_logged->GetPageId())->ForceLog(last_logged) &&
+            disk_manager_->WritePages(first_page_id, run);
+        if (ok)
+            written += run.size();
+        for (Page *page : pages)
+        {
+            page->RUnlatch();
+            GetInstance(page->GetPageId())->UnpinPage(page->GetPageId(), !ok);
+        }
     }
-    latch_.unlock();
-    return false;
+    // also covers the pages evicted or cleaned by the background writer
+    // since the last flush
+    disk_manager_->SyncPages();
+    return written;
 }
 
 /**
@@ -162,71 +255,354 @@ bool BufferPoolManager::FlushPage(page_id_t page_id)
  */
 bool BufferPoolManager::DeletePage(page_id_t page_id)
 {
-    Page *pp;
     if (page_id == INVALID_PAGE_ID)
         return false;
-    latch_.lock();
-    if (page_table_->Find(page_id, pp))
-    {
-        if (pp->pin_count_ != 0)
-        {
-            latch_.unlock();
-            return false;
-        }
-        page_table_->Remove(page_id);
-        pp->page_id_ = INVALID_PAGE_ID;
-        pp->pin_count_ = 0;
-        pp->is_dirty_ = false;
-        free_list_->push_back(pp);
-        disk_manager_->DeallocatePage(page_id);
-    }
-    latch_.unlock();
+    if (!GetInstance(page_id)->DeletePage(page_id))
+        return false;
+    disk_manager_->DeallocatePage(page_id);
     return true;
 }
 
 /**
  * User should call this method if needs to create a new page. This routine
- * will call disk manager to allocate a page.
- * Buffer pool manager should be responsible to choose a victim page either
- * from free list or lru replacer(NOTE: always choose from free list first),
- * update new page's metadata, zero out memory and add corresponding entry
- * into page table. return nullptr if all the pages in pool are pinned
+ * will call disk manager to allocate a page, then let the instance owning the
+ * new page id choose a frame for it (from the ring of strategy, if given).
+ * If every page of that instance is pinned, the page id is handed back to
+ * disk manager and nullptr is returned, as when no page can be allocated
+ * (read-only files). Pages created for the same owner are placed next to
+ * each other on disk
  */
-Page *BufferPoolManager::NewPage(page_id_t &page_id)
+Page *BufferPoolManager::NewPage(page_id_t &page_id,
+                                 BufferAccessStrategy *strategy,
+                                 page_id_t owner)
 {
-    Page *pp;
-    latch_.lock();
-    if (free_list_->size() > 0)
+    page_id_t new_page_id = disk_manager_->AllocatePage(owner);
+    if (new_page_id == INVALID_PAGE_ID)
     {
-        pp = free_list_->front();
-        free_list_->pop_front();
+        page_id = INVALID_PAGE_ID;
+        return nullptr;
     }
-    else if (replacer_->Victim(pp))
+    Page *pp = GetInstance(new_page_id)->NewPage(new_page_id,
+                                                 GetRing(new_page_id, strategy));
+    if (pp == nullptr)
     {
-        if (pp->pin_count_ > 0)
+        disk_manager_->DeallocatePage(new_page_id);
+        page_id = INVALID_PAGE_ID;
+        return nullptr;
+    }
+    page_id = new_page_id;
+    return pp;
+}
+
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id,
+                                               BufferAccessStrategy *strategy)
+{
+    return ReadPageGuard(this, FetchPage(page_id, strategy));
+}
+
+WritePageGuard
+BufferPoolManager::FetchPageWrite(page_id_t page_id,
+                                  BufferAccessStrategy *strategy)
+{
+    return WritePageGuard(this, FetchPage(page_id, strategy));
+}
+
+/*
+ * A new page is zeroed in memory only, so it is unpinned dirty even if the
+ * caller does not write to it
+ */
+WritePageGuard
+BufferPoolManager::NewPageGuarded(page_id_t &page_id,
+                                  BufferAccessStrategy *strategy,
+                                  page_id_t owner)
+{
+    return WritePageGuard(this, NewPage(page_id, strategy, owner), true);
+}
+
+/*
+ * Start the background writer, if not running yet. Every interval it writes
+ * back up to pages_per_round dirty unpinned pages from the eviction end of
+ * each instance, or every such page of an instance whose dirty ratio reached
+ * dirty_ratio
+ */
+void BufferPoolManager::RunBackgroundWriter(size_t pages_per_round,
+                                            std::chrono::milliseconds interval,
+                                            double dirty_ratio)
+{
+    std::lock_guard<std::mutex> guard(writer_latch_);
+    if (writer_thread_ != nullptr)
+        return;
+    writer_running_ = true;
+    writer_thread_ = new std::thread([=] {
+        std::unique_lock<std::mutex> lock(writer_latch_);
+        while (writer_running_)
         {
-            latch_.unlock();
-            return nullptr;
+            lock.unlock();
+            for (auto instance : instances_)
+            {
+                size_t max_pages = pages_per_round;
+                if (instance->GetDirtyRatio() >= dirty_ratio)
+                    max_pages = instance->GetPoolSize();
+                instance->WriteBackDirtyPages(max_pages);
+            }
+            lock.lock();
+            writer_cv_.wait_for(lock, interval,
+                                [this] { return !writer_running_; });
         }
-        if (pp->is_dirty_)
+    });
+}
+
+/*
+ * Stop and join the background writer
+ */
+void BufferPoolManager::StopBackgroundWriter()
+{
+    std::thread *writer_thread;
+    {
+        std::lock_guard<std::mutex> guard(writer_latch_);
+        writer_running_ = false;
+        writer_thread = writer_thread_;
+        writer_thread_ = nullptr;
+    }
+    writer_cv_.notify_all();
+    if (writer_thread != nullptr)
+    {
+        writer_thread->join();
+        delete writer_thread;
+    }
+}
+
+/*
+ * Resize every instance to its share of pool_size. Frames still pinned are
+ * left to the resize thread, which retries at the background writer's
+ * interval until all of them are released. An instance that cannot map
+ * huge pages to grow into keeps its size, and false is returned
+ */
+bool BufferPoolManager::Resize(size_t pool_size)
+{
+    size_t num_instances = instances_.size();
+    if (pool_size < num_instances)
+        return false;
+    for (size_t i = 0; i < num_instances; ++i)
+    {
+        size_t instance_size = pool_size / num_instances +
+                               (i < pool_size % num_instances ? 1 : 0);
+        if (instance_size > instances_[i]->GetMaxPoolSize())
+            return false;
+    }
+    std::lock_guard<std::mutex> guard(resize_latch_);
+    bool pending = false;
+    bool resized = true;
+    size_t new_pool_size = 0;
+    for (size_t i = 0; i < num_instances; ++i)
+    {
+        size_t instance_size = pool_size / num_instances +
+                               (i < pool_size % num_instances ? 1 : 0);
+        // an instance out of huge pages keeps its size
+        resized = instances_[i]->Resize(instance_size) && resized;
+        pending = instances_[i]->ReleaseFrames() > 0 || pending;
+        new_pool_size += instances_[i]->GetPoolSize();
+    }
+    pool_size_ = new_pool_size;
+    resize_pending_ = pending;
+    if (pending && resize_thread_ == nullptr)
+    {
+        resize_running_ = true;
+        resize_thread_ = new std::thread([this] {
+            std::unique_lock<std::mutex> lock(resize_latch_);
+            while (resize_running_)
+            {
+                if (!resize_pending_)
+                {
+                    // idle until the next shrink leaves pinned frames
+                    resize_cv_.wait(lock, [this] {
+                        return !resize_running_ || resize_pending_;
+                    });
+                    continue;
+                }
+                resize_cv_.wait_for(lock, BG_WRITER_INTERVAL, [this] {
+                    return !resize_running_;
+                });
+                bool pending = false;
+                for (auto instance : instances_)
+                    pending = instance->ReleaseFrames() > 0 || pending;
+                resize_pending_ = pending;
+            }
+        });
+    }
+    resize_cv_.notify_all();
+    return resized;
+}
+
+bool BufferPoolManager::IsResizing()
+{
+    std::lock_guard<std::mutex> guard(resize_latch_);
+    return resize_pending_;
+}
+
+// side file of DumpResidentPages: magic, number of pages, page ids
+static const uint32_t WARMUP_FILE_MAGIC = 0x4d524157;
+
+/*
+ * The lists of the instances are interleaved, so that the head of the file
+ * holds the hottest pages of every instance. The file is written under a
+ * temporary name and renamed, a crash never leaves half a list behind
+ */
+bool BufferPoolManager::DumpResidentPages(const std::string &file_name)
+{
+    std::vector<std::vector<page_id_t>> lists(instances_.size());
+    size_t longest = 0;
+    for (size_t i = 0; i < instances_.size(); ++i)
+    {
+        instances_[i]->GetResidentPages(lists[i]);
+        longest = std::max(longest, lists[i].size());
+    }
+    std::vector<page_id_t> page_ids;
+    for (size_t rank = 0; rank < longest; ++rank)
+        for (auto &list : lists)
+            if (rank < list.size())
+                page_ids.push_back(list[rank]);
+
+    std::string tmp_file_name = file_name + ".tmp";
+    std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc);
+    uint32_t header[2] = {WARMUP_FILE_MAGIC, uint32_t(page_ids.size())};
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(page_ids.data()),
+              page_ids.size() * sizeof(page_id_t));
+    out.close();
+    if (!out)
+    {
+        remove(tmp_file_name.c_str());
+        return false;
+    }
+    return rename(tmp_file_name.c_str(), file_name.c_str()) == 0;
+}
+
+/*
+ * Only as many pages as the pool holds are read, hottest first; sorting
+ * them turns the reads into a sweep over the file, with consecutive pages
+ * read together. Pages no longer in the file are skipped
+ */
+bool BufferPoolManager::WarmUp(const std::string &file_name)
+{
+    std::ifstream in(file_name, std::ios::binary);
+    uint32_t header[2];
+    if (!in.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+        header[0] != WARMUP_FILE_MAGIC)
+        return false;
+    std::vector<page_id_t> page_ids(std::min<size_t>(header[1], pool_size_));
+    if (!in.read(reinterpret_cast<char *>(page_ids.data()),
+                 page_ids.size() * sizeof(page_id_t)))
+        return false;
+    std::sort(page_ids.begin(), page_ids.end());
+    page_ids.erase(std::unique(page_ids.begin(), page_ids.end()),
+                   page_ids.end());
+
+    if (warmup_thread_ != nullptr)
+    {
+        warmup_thread_->join();
+        delete warmup_thread_;
+    }
+    warmup_running_ = true;
+    warmup_thread_ = new std::thread([this, page_ids] {
+        size_t page_size = GetPageSize();
+        // page aligned, like the frames, for direct I/O
+        FrameArena buffer(WARMUP_READ_PAGES * page_size);
+        // instances without free frames left
+        std::vector<bool> full(instances_.size(), false);
+        size_t num_full = 0;
+        size_t i = 0;
+        while (i < page_ids.size() && num_full < instances_.size() &&
+               warmup_running_)
         {
-            pp->WLatch();
-            disk_manager_->WritePage(pp->page_id_, pp->data_);
-            pp->WUnlatch();
+            size_t count = 1;
+            while (i + count < page_ids.size() && count < WARMUP_READ_PAGES &&
+                   page_ids[i + count] == page_ids[i] + page_id_t(count))
+                count++;
+            // frames are claimed before the read, fetchers of these pages
+            // wait for it rather than read an older copy themselves
+            std::vector<Page *> frames(count, nullptr);
+            size_t claimed = 0;
+            for (size_t j = 0; j < count; ++j)
+            {
+                size_t index = GetInstanceIndex(page_ids[i + j]);
+                if (full[index])
+                    continue;
+                bool no_frame;
+                BufferPoolInstance *instance = instances_[index];
+                frames[j] = instance->ClaimFreeFrame(page_ids[i + j], no_frame);
+                if (frames[j] != nullptr)
+                    claimed++;
+                if (no_frame)
+                {
+                    full[index] = true;
+                    num_full++;
+                }
+            }
+            if (claimed == 0)
+            {
+                i += count;
+                continue;
+            }
+            // a page failing its checksum is left to FetchPage to report
+            std::vector<bool> valid;
+            size_t read_count = disk_manager_->ReadPages(
+                page_ids[i], count, buffer.GetData(), &valid);
+            for (size_t j = 0; j < count; ++j)
+            {
+                if (frames[j] == nullptr)
+                    continue;
+                bool ok = j < read_count && valid[j];
+                instances_[GetInstanceIndex(page_ids[i + j])]->WarmPage(
+                    frames[j], page_ids[i + j],
+                    ok ? buffer.GetData() + j * page_size : nullptr);
+            }
+            i += count;
         }
-        page_table_->Remove(pp->page_id_);
+        warmup_running_ = false;
+    });
+    return true;
+}
+
+bool BufferPoolManager::IsWarmingUp()
+{
+    return warmup_running_;
+}
+
+/*
+ * Start dumping the resident pages every interval, if not running yet
+ */
+void BufferPoolManager::RunResidentPageDumper(
+    const std::string &file_name, std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> guard(dumper_latch_);
+    if (dumper_thread_ != nullptr)
+        return;
+    dumper_running_ = true;
+    dumper_file_name_ = file_name;
+    dumper_thread_ = new std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(dumper_latch_);
+        while (!dumper_cv_.wait_for(lock, interval,
+                                    [this] { return !dumper_running_; }))
+            DumpResidentPages(dumper_file_name_);
+    });
+}
+
+void BufferPoolManager::StopResidentPageDumper()
+{
+    std::thread *dumper_thread;
+    {
+        std::lock_guard<std::mutex> guard(dumper_latch_);
+        dumper_running_ = false;
+        dumper_thread = dumper_thread_;
+        dumper_thread_ = nullptr;
     }
-    else{
-        latch_.unlock();
-        return nullptr;
+    dumper_cv_.notify_all();
+    if (dumper_thread != nullptr)
+    {
+        dumper_thread->join();
+        delete dumper_thread;
+        DumpResidentPages(dumper_file_name_);
     }
-    page_id = disk_manager_->AllocatePage();
-    page_table_->Insert(page_id, pp);
-    pp->page_id_ = page_id;
-    pp->pin_count_++;
-    pp->is_dirty_ = false;
-    pp->ResetMemory();
-    latch_.unlock();
-    return pp;
 }
 } // namespace cmudb
@@ -0,0 +1,100 @@
+#include <functional>
+#include <thread>
+
+#include "buffer/buffer_pool_stats.h"
+
+namespace cmudb
+{
+
+void HistogramSnapshot::Merge(const HistogramSnapshot &that)
+{
+    count_ += that.count_;
+    sum_ += that.sum_;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        buckets_[i] += that.buckets_[i];
+}
+
+double HistogramSnapshot::GetMean() const
+{
+    return count_ == 0 ? 0 : double(sum_) / count_;
+}
+
+uint64_t HistogramSnapshot::GetPercentile(double fraction) const
+{
+    if (count_ == 0)
+        return 0;
+    uint64_t rank = fraction * count_;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+        seen += buckets_[i];
+        if (seen > rank)
+            return uint64_t(1) << i;
+    }
+    return uint64_t(1) << (HISTOGRAM_BUCKETS - 1);
+}
+
+void BufferPoolStats::Merge(const BufferPoolStats &that)
+{
+    for (size_t i = 0; i < static_cast<size_t>(BufferPoolEvent::NUM_EVENTS);
+         ++i)
+        events_[i] += that.events_[i];
+    read_latency_.Merge(that.read_latency_);
+    write_latency_.Merge(that.write_latency_);
+    latch_wait_.Merge(that.latch_wait_);
+    page_latch_wait_.Merge(that.page_latch_wait_);
+}
+
+double BufferPoolStats::GetHitRatio() const
+{
+    uint64_t fetches = Get(BufferPoolEvent::HIT) + Get(BufferPoolEvent::MISS);
+    return fetches == 0 ? 0 : double(Get(BufferPoolEvent::HIT)) / fetches;
+}
+
+void LatencyHistogram::Record(std::chrono::steady_clock::duration latency)
+{
+    uint64_t nanos =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+    // bucket of the highest bit set, the last one takes everything above
+    size_t bucket = nanos == 0 ? 0 : 64 - __builtin_clzll(nanos);
+    if (bucket >= HISTOGRAM_BUCKETS)
+        bucket = HISTOGRAM_BUCKETS - 1;
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(nanos, std::memory_order_relaxed);
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+HistogramSnapshot LatencyHistogram::Snapshot() const
+{
+    HistogramSnapshot snapshot;
+    snapshot.count_ = count_.load(std::memory_order_relaxed);
+    snapshot.sum_ = sum_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+        snapshot.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+BufferPoolStats BufferPoolCounters::Snapshot() const
+{
+    BufferPoolStats stats;
+    for (size_t i = 0; i < static_cast<size_t>(BufferPoolEvent::NUM_EVENTS);
+         ++i)
+        stats.events_[i] = Get(static_cast<BufferPoolEvent>(i));
+    stats.read_latency_ = read_latency_.Snapshot();
+    stats.write_latency_ = write_latency_.Snapshot();
+    stats.latch_wait_ = latch_wait_.Snapshot();
+    stats.page_latch_wait_ = page_latch_wait_.Snapshot();
+    return stats;
+}
+
+/*
+ * Threads keep to one shard, picked once from their id
+ */
+size_t BufferPoolCounters::GetShardIndex()
+{
+    static thread_local size_t shard_index =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) %
+        STATS_SHARDS;
+    return shard_index;
+}
+} // namespace cmudb
@@ -0,0 +1,153 @@
+/**
+ * CLOCK implementation
+ */
+#include <cassert>
+
+#include "buffer/clock_replacer.h"
+#include "page/page.h"
+
+namespace cmudb
+{
+
+template <typename T>
+ClockReplacer<T>::ClockReplacer(size_t num_frames, const T &base)
+    : num_frames_(num_frames), num_slots_(num_frames), base_(base), size_(0),
+      hand_(0)
+{
+    state_ = new std::atomic<char>[num_frames_];
+    for (size_t i = 0; i < num_frames_; ++i)
+        state_[i] = NOT_EVICTABLE;
+}
+
+template <typename T>
+ClockReplacer<T>::~ClockReplacer()
+{
+    delete[] state_;
+}
+
+/*
+ * Mark value as evictable and referenced, so the clock hand gives it a second
+ * chance before evicting it
+ */
+template <typename T>
+void ClockReplacer<T>::Insert(const T &value)
+{
+    size_t frame_id = FrameId(value);
+    assert(frame_id < num_slots_);
+    if (state_[frame_id].exchange(REFERENCED) == NOT_EVICTABLE)
+        size_++;
+}
+
+/*
+ * Sweep the clock hand, clearing reference bits on the way, until an
+ * evictable frame without reference bit is found. Two full rounds are always
+ * enough unless concurrent Insert/Erase keep changing the frames. Return
+ * false if nothing is evictable
+ */
+template <typename T>
+bool ClockReplacer<T>::Victim(T &value)
+{
+    return Victim(value, nullptr);
+}
+
+/*
+ * Frames rejected by can_evict (if not empty) are passed over, their slot
+ * left as it is. can_evict is called before the slot is taken, which cannot
+ * fail afterwards as long as Insert/Erase do not run concurrently with
+ * Victim (the buffer pool calls them all under its latch)
+ */
+template <typename T>
+bool ClockReplacer<T>::Victim(T &value,
+                              const std::function<bool(const T &)> &can_evict)
+{
+    std::lock_guard<std::mutex> guard(hand_latch_);
+    for (size_t i = 0; i < 2 * num_frames_ && size_ > 0; ++i)
+    {
+        size_t frame_id = hand_;
+        hand_ = (hand_ + 1) % num_frames_;
+        char state = state_[frame_id];
+        if (state == REFERENCED)
+        {
+            state_[frame_id].compare_exchange_strong(state, EVICTABLE);
+        }
+        else if (state == EVICTABLE &&
+                 (!can_evict || can_evict(base_ + frame_id)) &&
+                 state_[frame_id].compare_exchange_strong(state, NOT_EVICTABLE))
+        {
+            size_--;
+            value = base_ + frame_id;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Make value not evictable. If value was evictable return true, otherwise
+ * return false
+ */
+template <typename T>
+bool ClockReplacer<T>::Erase(const T &value)
+{
+    size_t frame_id = FrameId(value);
+    assert(frame_id < num_slots_);
+    if (state_[frame_id].exchange(NOT_EVICTABLE) == NOT_EVICTABLE)
+        return false;
+    size_--;
+    return true;
+}
+
+template <typename T>
+size_t ClockReplacer<T>::Size() { return size_; }
+
+/*
+ * Frames the hand would take on its first round (no reference bit), then
+ * the referenced ones it takes on the second round
+ */
+template <typename T>
+void ClockReplacer<T>::GetVictimCandidates(std::vector<T> &candidates,
+                                           size_t max_values)
+{
+    std::lock_guard<std::mutex> guard(hand_latch_);
+    for (char wanted : {EVICTABLE, REFERENCED})
+    {
+        for (size_t i = 0; i < num_frames_ && max_values > 0; ++i)
+        {
+            size_t frame_id = (hand_ + i) % num_frames_;
+            if (state_[frame_id] == wanted)
+            {
+                candidates.push_back(base_ + frame_id);
+                max_values--;
+            }
+        }
+    }
+}
+
+/*
+ * Sweep capacity frames from now on. Growing past the slots allocated so
+ * far moves the slots to a larger array
+ */
+template <typename T>
+void ClockReplacer<T>::SetCapacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> guard(hand_latch_);
+    if (capacity > num_slots_)
+    {
+        std::atomic<char> *state = new std::atomic<char>[capacity];
+        for (size_t i = 0; i < capacity; ++i)
+            state[i] = i < num_slots_ ? state_[i].load()
+                                      : static_cast<char>(NOT_EVICTABLE);
+        delete[] state_;
+        state_ = state;
+        num_slots_ = capacity;
+    }
+    num_frames_ = capacity;
+    if (hand_ >= num_frames_)
+        hand_ = 0;
+}
+
+template class ClockReplacer<Page *>;
+// test only
+template class ClockReplacer<int>;
+
+} // namespace cmudb
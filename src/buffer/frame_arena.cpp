@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "buffer/frame_arena.h"
+#include "common/config.h"
+#include "common/logger.h"
+
+namespace cmudb
+{
+
+static inline size_t RoundUp(size_t size, size_t unit)
+{
+    return (size + unit - 1) / unit * unit;
+}
+
+FrameArena::FrameArena(size_t size, bool huge_pages, size_t committed)
+    : data_(nullptr), size_(0), huge_tlb_(false)
+{
+    if (size == 0)
+        size = 1;
+#ifdef MAP_HUGETLB
+    if (huge_pages)
+    {
+        // reserve address space only, aligned for huge page mappings
+        size_ = RoundUp(size, HUGE_PAGE_SIZE);
+        void *addr = mmap(nullptr, size_ + HUGE_PAGE_SIZE, PROT_NONE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (addr == MAP_FAILED)
+            throw std::bad_alloc();
+        char *begin = static_cast<char *>(addr);
+        data_ = reinterpret_cast<char *>(
+            RoundUp(reinterpret_cast<uintptr_t>(begin), HUGE_PAGE_SIZE));
+        if (data_ > begin)
+            munmap(begin, data_ - begin);
+        munmap(data_ + size_, begin + HUGE_PAGE_SIZE - data_);
+        huge_tlb_ = true;
+        committed_.assign(size_ / HUGE_PAGE_SIZE, false);
+        if (Commit(0, std::min(std::max(committed, size_t(1)), size_)))
+            return;
+        munmap(data_, size_);
+        data_ = nullptr;
+        huge_tlb_ = false;
+        committed_.clear();
+    }
+#endif
+    size_ = RoundUp(size, sysconf(_SC_PAGESIZE));
+    void *addr = mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (addr == MAP_FAILED)
+        throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+    // no huge pages reserved, let the kernel collapse the arena instead
+    if (huge_pages && madvise(addr, size_, MADV_HUGEPAGE) != 0)
+    {
+        LOG_DEBUG("transparent huge pages not available");
+    }
+#endif
+    data_ = static_cast<char *>(addr);
+}
+
+/*
+ * Map huge pages over the ones of [offset, offset + size) not mapped yet.
+ * Normal pages are committed when touched, nothing to do for them
+ */
+bool FrameArena::Commit(size_t offset, size_t size)
+{
+#ifdef MAP_HUGETLB
+    if (!huge_tlb_)
+        return true;
+    size_t end = RoundUp(offset + size, HUGE_PAGE_SIZE) / HUGE_PAGE_SIZE;
+    for (size_t i = offset / HUGE_PAGE_SIZE; i < end; ++i)
+    {
+        if (committed_[i])
+            continue;
+        void *addr = mmap(data_ + i * HUGE_PAGE_SIZE, HUGE_PAGE_SIZE,
+                          PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_FIXED,
+                          -1, 0);
+        if (addr == MAP_FAILED)
+        {
+            LOG_DEBUG("no huge pages left to commit");
+            return false;
+        }
+        committed_[i] = true;
+    }
+#else
+    (void)offset;
+    (void)size;
+#endif
+    return true;
+}
+
+void FrameArena::Release(size_t offset, size_t size)
+{
+    size_t unit = huge_tlb_ ? HUGE_PAGE_SIZE : sysconf(_SC_PAGESIZE);
+    size_t begin = RoundUp(offset, unit);
+    size_t end = (offset + size) / unit * unit;
+    if (begin >= end)
+        return;
+    if (!huge_tlb_)
+    {
+        madvise(data_ + begin, end - begin, MADV_DONTNEED);
+        return;
+    }
+    // huge pages go back to the pool only once they are unmapped, the
+    // address space stays reserved for a later Commit
+    for (size_t i = begin / unit; i < end / unit; ++i)
+    {
+        if (!committed_[i])
+            continue;
+        if (mmap(data_ + i * unit, unit, PROT_NONE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1,
+                 0) != MAP_FAILED)
+            committed_[i] = false;
+    }
+}
+
+FrameArena::~FrameArena()
+{
+    munmap(data_, size_);
+}
+} // namespace cmudb
@@ -0,0 +1,179 @@
+/**
+ * LRU-K implementation
+ */
+#include "buffer/lru_k_replacer.h"
+#include "page/page.h"
+
+namespace cmudb
+{
+
+template <typename T>
+LRUKReplacer<T>::LRUKReplacer(size_t k, size_t correlation_period)
+    : k_(k == 0 ? 1 : k), correlation_period_(correlation_period),
+      current_timestamp_(0) {}
+
+template <typename T>
+LRUKReplacer<T>::~LRUKReplacer() {}
+
+template <typename T>
+void LRUKReplacer<T>::RemoveCandidate(const T &value, History &history)
+{
+    if (!history.evictable)
+        return;
+    if (history.timestamps.size() < k_)
+        infinite_.erase(GetCandidate(value, history));
+    else
+        finite_.erase(GetCandidate(value, history));
+    history.evictable = false;
+}
+
+/*
+ * Record an access of value and make it not evictable until the next Insert.
+ * An access correlated with the previous one replaces it instead of adding
+ * to the history
+ */
+template <typename T>
+void LRUKReplacer<T>::RecordAccess(const T &value)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    History &history = history_[value];
+    RemoveCandidate(value, history);
+    if (!history.timestamps.empty() &&
+        current_timestamp_ - history.timestamps.back() <= correlation_period_)
+    {
+        history.timestamps.back() = current_timestamp_++;
+        return;
+    }
+    history.timestamps.push_back(current_timestamp_++);
+    if (history.timestamps.size() > k_)
+        history.timestamps.pop_front();
+}
+
+/*
+ * Make value evictable. A value without history counts Insert as its first
+ * access
+ */
+template <typename T>
+void LRUKReplacer<T>::Insert(const T &value)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    History &history = history_[value];
+    if (history.timestamps.empty())
+        history.timestamps.push_back(current_timestamp_++);
+    if (history.evictable)
+        return;
+    history.evictable = true;
+    if (history.timestamps.size() < k_)
+        infinite_.insert(GetCandidate(value, history));
+    else
+        finite_.insert(GetCandidate(value, history));
+}
+
+/*
+ * Evict the value with the largest backward k-distance and forget its
+ * history. Return false if nothing is evictable
+ */
+template <typename T>
+bool LRUKReplacer<T>::Victim(T &value)
+{
+    return Victim(value, nullptr);
+}
+
+/*
+ * Victim among the values accepted by can_evict (any value if it is empty).
+ * The rejected ones keep their history
+ */
+template <typename T>
+bool LRUKReplacer<T>::Victim(T &value,
+                             const std::function<bool(const T &)> &can_evict)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    for (auto set : {&infinite_, &finite_})
+    {
+        for (auto it = set->begin(); it != set->end(); ++it)
+        {
+            if (can_evict && !can_evict(it->second))
+                continue;
+            value = it->second;
+            set->erase(it);
+            history_.erase(value);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Like Victim, the history of value is forgotten
+ */
+template <typename T>
+bool LRUKReplacer<T>::Evict(const T &value)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = history_.find(value);
+    if (it == history_.end() || !it->second.evictable)
+        return false;
+    RemoveCandidate(value, it->second);
+    history_.erase(it);
+    return true;
+}
+
+/*
+ * Make value not evictable, its history is kept. If value was evictable
+ * return true, otherwise return false
+ */
+template <typename T>
+bool LRUKReplacer<T>::Erase(const T &value)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = history_.find(value);
+    if (it == history_.end() || !it->second.evictable)
+        return false;
+    RemoveCandidate(value, it->second);
+    return true;
+}
+
+/*
+ * Forget value together with its history
+ */
+template <typename T>
+void LRUKReplacer<T>::Remove(const T &value)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = history_.find(value);
+    if (it == history_.end())
+        return;
+    RemoveCandidate(value, it->second);
+    history_.erase(it);
+}
+
+template <typename T>
+size_t LRUKReplacer<T>::Size()
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    return infinite_.size() + finite_.size();
+}
+
+/*
+ * Values with less than k accesses first, then by backward k-distance
+ */
+template <typename T>
+void LRUKReplacer<T>::GetVictimCandidates(std::vector<T> &candidates,
+                                          size_t max_values)
+{
+    std::lock_guard<std::mutex> guard(mtx);
+    for (auto set : {&infinite_, &finite_})
+    {
+        for (auto it = set->begin(); it != set->end() && max_values > 0; ++it)
+        {
+            candidates.push_back(it->second);
+            max_values--;
+        }
+    }
+}
+
+template class LRUKReplacer<Page *>;
+// test only
+template class LRUKReplacer<int>;
+
+} // namespace cmudb
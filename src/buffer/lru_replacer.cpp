@@ -36,32 +36,20 @@ template <typename T>
 void LRUReplacer<T>::Insert(const T &value)
 {
     mtx.lock();
-    if (tail == NULL)
-    {
-        LRUlist<T> *pp = new LRUlist<T>;
-        pp->value = value;
-        pp->next = NULL;
-        pp->prev = NULL;
-        head = tail = pp;
-        size++;
-        metadata[value] = pp;
-    }
-    else
-    {
-        if(metadata.count(value)){
-            mtx.unlock();
-            Erase(value);
-            mtx.lock();
-        }
-        LRUlist<T> *pp = new LRUlist<T>;
-        pp->value = value;
-        pp->next = NULL;
-        pp->prev = tail;
-        tail->next = pp;
-        tail = pp;
-        size++;
-        metadata[value] = pp;
+    if(metadata.count(value)){
+        mtx.unlock();
+        Erase(value);
+        mtx.lock();
     }
+    LRUlist<T> *pp = new LRUlist<T>;
+    pp->value = value;
+    pp->next = NULL;
+    pp->prev = tail;
+    if(tail == NULL) head = pp;
+    else tail->next = pp;
+    tail = pp;
+    size++;
+    metadata[value] = pp;
     mtx.unlock();
 }
 
@@ -71,15 +59,32 @@ void LRUReplacer<T>::Insert(const T &value)
 template <typename T>
 bool LRUReplacer<T>::Victim(T &value)
 {
-    if (size == 0)
-        return false;
+    return Victim(value, nullptr);
+}
+
+/*
+ * Least recently used member accepted by can_evict (any member if it is
+ * empty), the rejected ones keep their place
+ */
+template <typename T>
+bool LRUReplacer<T>::Victim(T &value,
+                            const std::function<bool(const T &)> &can_evict)
+{
     mtx.lock();
     LRUlist<T> *vic = head;
+    while (vic != NULL && can_evict && !can_evict(vic->value))
+        vic = vic->next;
+    if (vic == NULL)
+    {
+        mtx.unlock();
+        return false;
+    }
     value = vic->value;
-    head = head->next;
-    if(head != NULL) head->prev = NULL;
+    if(vic->prev != NULL) vic->prev->next = vic->next;
+    else head = vic->next;
+    if(vic->next != NULL) vic->next->prev = vic->prev;
+    else tail = vic->prev;
     size--;
-    if(size == 0) tail = NULL;
     delete vic;
     metadata.erase(value);
     mtx.unlock();
@@ -96,18 +101,11 @@ bool LRUReplacer<T>::Erase(const T &value)
     mtx.lock();
     if(metadata.count(value)){
         LRUlist<T> *pp = metadata[value];
-        if(pp == head){
-            head = pp->next;
-            if(head != NULL) head->prev = NULL;
-        }
-        else if(pp == tail){
-            tail = pp->prev;
-            if(tail != NULL) tail->next = NULL;
-        }
-        else{
-            pp->prev->next = pp->next;
-            pp->next->prev = pp->prev;
-        }
+        // the only member is both head and tail
+        if(pp->prev != NULL) pp->prev->next = pp->next;
+        else head = pp->next;
+        if(pp->next != NULL) pp->next->prev = pp->prev;
+        else tail = pp->prev;
         metadata.erase(value);
         size--;
         delete pp;
@@ -121,6 +119,22 @@ bool LRUReplacer<T>::Erase(const T &value)
 template <typename T>
 size_t LRUReplacer<T>::Size() { return size; }
 
+/*
+ * Least recently used values first
+ */
+template <typename T>
+void LRUReplacer<T>::GetVictimCandidates(std::vector<T> &candidates,
+                                         size_t max_values)
+{
+    mtx.lock();
+    for (LRUlist<T> *pp = head; pp != NULL && max_values > 0; pp = pp->next)
+    {
+        candidates.push_back(pp->value);
+        max_values--;
+    }
+    mtx.unlock();
+}
+
 template class LRUReplacer<Page *>;
 // test only
 template class LRUReplacer<int>;
@@ -0,0 +1,101 @@
+#include "buffer/page_guard.h"
+#include "buffer/buffer_pool_manager.h"
+
+namespace cmudb
+{
+
+/*
+ * Latch a page for a guard, timing the wait only when the latch is taken
+ */
+static void LatchPage(BufferPoolManager *buffer_pool_manager, Page *page,
+                      bool exclusive)
+{
+    if (exclusive ? page->TryWLatch() : page->TryRLatch())
+        return;
+    auto start = std::chrono::steady_clock::now();
+    if (exclusive)
+        page->WLatch();
+    else
+        page->RLatch();
+    buffer_pool_manager->RecordPageLatchWait(
+        page->GetPageId(), std::chrono::steady_clock::now() - start);
+}
+
+ReadPageGuard::ReadPageGuard(BufferPoolManager *buffer_pool_manager,
+                             Page *page)
+    : buffer_pool_manager_(buffer_pool_manager), page_(page)
+{
+    if (page_ != nullptr)
+        LatchPage(buffer_pool_manager_, page_, false);
+}
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept
+    : buffer_pool_manager_(that.buffer_pool_manager_), page_(that.page_)
+{
+    that.page_ = nullptr;
+}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&that) noexcept
+{
+    if (this != &that)
+    {
+        Drop();
+        buffer_pool_manager_ = that.buffer_pool_manager_;
+        page_ = that.page_;
+        that.page_ = nullptr;
+    }
+    return *this;
+}
+
+void ReadPageGuard::Drop()
+{
+    if (page_ == nullptr)
+        return;
+    page_id_t page_id = page_->GetPageId();
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_ = nullptr;
+}
+
+WritePageGuard::WritePageGuard(BufferPoolManager *buffer_pool_manager,
+                               Page *page, bool is_dirty)
+    : buffer_pool_manager_(buffer_pool_manager), page_(page),
+      is_dirty_(is_dirty)
+{
+    if (page_ != nullptr)
+        LatchPage(buffer_pool_manager_, page_, true);
+}
+
+WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept
+    : buffer_pool_manager_(that.buffer_pool_manager_), page_(that.page_),
+      is_dirty_(that.is_dirty_)
+{
+    that.page_ = nullptr;
+    that.is_dirty_ = false;
+}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&that) noexcept
+{
+    if (this != &that)
+    {
+        Drop();
+        buffer_pool_manager_ = that.buffer_pool_manager_;
+        page_ = that.page_;
+        is_dirty_ = that.is_dirty_;
+        that.page_ = nullptr;
+        that.is_dirty_ = false;
+    }
+    return *this;
+}
+
+void WritePageGuard::Drop()
+{
+    if (page_ == nullptr)
+        return;
+    page_id_t page_id = page_->GetPageId();
+    page_->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, is_dirty_);
+    page_ = nullptr;
+    is_dirty_ = false;
+}
+} // namespace cmudb
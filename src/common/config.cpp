@@ -4,4 +4,11 @@ namespace cmudb {
   std::atomic<bool> ENABLE_LOGGING(false);  // for virtual table
   std::chrono::duration<long long int> LOG_TIMEOUT =
    std::chrono::seconds(1);
+  // pause between two rounds of the buffer pool background writer
+  std::chrono::milliseconds BG_WRITER_INTERVAL =
+   std::chrono::milliseconds(100);
+  bool BUFFER_POOL_HUGE_PAGES = false;
+  // pause between two dumps of the resident pages for warm-up
+  std::chrono::milliseconds WARMUP_DUMP_INTERVAL =
+   std::chrono::milliseconds(60000);
 }
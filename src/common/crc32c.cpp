@@ -0,0 +1,113 @@
+/**
+ * crc32c.cpp
+ */
+#include <cstring>
+
+#include "common/crc32c.h"
+#ifdef CRC32C_SSE42
+#include <nmmintrin.h>
+#endif
+
+namespace cmudb {
+
+static const uint32_t CRC32C_POLY = 0x82f63b78; // reflected
+// bytes of each of the three streams checksummed at once by the hardware
+static const size_t CRC32C_STREAM = 256;
+
+// tables_[k][b]: crc of byte b followed by k zero bytes
+// shift_[k][b]: crc of byte b << 8k followed by CRC32C_STREAM zero bytes,
+// to append that many bytes to a crc computed on its own
+struct Crc32cTables {
+  Crc32cTables() {
+    for (uint32_t b = 0; b < 256; ++b) {
+      uint32_t crc = b;
+      for (int i = 0; i < 8; ++i)
+        crc = (crc >> 1) ^ (CRC32C_POLY & (0 - (crc & 1)));
+      tables_[0][b] = crc;
+    }
+    for (uint32_t b = 0; b < 256; ++b)
+      for (int k = 1; k < 8; ++k)
+        tables_[k][b] =
+            (tables_[k - 1][b] >> 8) ^ tables_[0][tables_[k - 1][b] & 0xff];
+    for (uint32_t b = 0; b < 256; ++b) {
+      for (int k = 0; k < 4; ++k) {
+        uint32_t crc = b << (8 * k);
+        for (size_t i = 0; i < CRC32C_STREAM; ++i)
+          crc = (crc >> 8) ^ tables_[0][crc & 0xff];
+        shift_[k][b] = crc;
+      }
+    }
+  }
+  uint32_t tables_[8][256];
+  uint32_t shift_[4][256];
+};
+
+static const Crc32cTables &GetTables() {
+  static const Crc32cTables tables;
+  return tables;
+}
+
+uint32_t Crc32cTable(const char *data, size_t size) {
+  auto &t = GetTables().tables_;
+  auto p = reinterpret_cast<const unsigned char *>(data);
+  uint32_t crc = 0xffffffff;
+  // 8 bytes per step, the tables fold them in at once (little endian)
+  for (; size >= 8; size -= 8, p += 8) {
+    uint32_t low, high;
+    memcpy(&low, p, 4);
+    memcpy(&high, p + 4, 4);
+    low ^= crc;
+    crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff] ^
+          t[5][(low >> 16) & 0xff] ^ t[4][low >> 24] ^ t[3][high & 0xff] ^
+          t[2][(high >> 8) & 0xff] ^ t[1][(high >> 16) & 0xff] ^
+          t[0][high >> 24];
+  }
+  for (; size > 0; --size, ++p)
+    crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xff];
+  return ~crc;
+}
+
+#ifdef CRC32C_SSE42
+static inline uint64_t Load64(const char *data) {
+  uint64_t word;
+  memcpy(&word, data, 8);
+  return word;
+}
+
+uint32_t Crc32cHardware(const char *data, size_t size) {
+  auto &s = GetTables().shift_;
+  uint64_t crc = 0xffffffff;
+  // a crc32 instruction takes three cycles but one can start every cycle,
+  // so three independent streams are checksummed and then concatenated
+  for (; size >= 3 * CRC32C_STREAM;
+       size -= 3 * CRC32C_STREAM, data += 3 * CRC32C_STREAM) {
+    uint64_t crc1 = 0, crc2 = 0;
+    for (size_t i = 0; i < CRC32C_STREAM; i += 8) {
+      crc = _mm_crc32_u64(crc, Load64(data + i));
+      crc1 = _mm_crc32_u64(crc1, Load64(data + CRC32C_STREAM + i));
+      crc2 = _mm_crc32_u64(crc2, Load64(data + 2 * CRC32C_STREAM + i));
+    }
+    crc = s[0][crc & 0xff] ^ s[1][(crc >> 8) & 0xff] ^
+          s[2][(crc >> 16) & 0xff] ^ s[3][crc >> 24] ^ crc1;
+    crc = s[0][crc & 0xff] ^ s[1][(crc >> 8) & 0xff] ^
+          s[2][(crc >> 16) & 0xff] ^ s[3][crc >> 24] ^ crc2;
+  }
+  for (; size >= 8; size -= 8, data += 8) {
+    crc = _mm_crc32_u64(crc, Load64(data));
+  }
+  uint32_t crc32 = static_cast<uint32_t>(crc);
+  for (; size > 0; --size, ++data)
+    crc32 = _mm_crc32_u8(crc32, static_cast<unsigned char>(*data));
+  return ~crc32;
+}
+#endif
+
+uint32_t Crc32c(const char *data, size_t size) {
+#ifdef CRC32C_SSE42
+  return Crc32cHardware(data, size);
+#else
+  return Crc32cTable(data, size);
+#endif
+}
+
+} // namespace cmudb
@@ -0,0 +1,320 @@
+/**
+ * async_io.cpp
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <system_error>
+#include <unistd.h>
+
+#include "common/logger.h"
+#include "disk/async_io.h"
+
+namespace cmudb {
+
+AsyncIO *AsyncIO::Create(size_t queue_depth, bool use_io_uring) {
+  if (use_io_uring) {
+    try {
+      return new IOUring(queue_depth);
+    } catch (std::system_error &e) {
+      LOG_DEBUG("no io_uring (%s), using I/O threads", e.what());
+    }
+  }
+  return new ThreadPoolIO(queue_depth);
+}
+
+/*
+ * ThreadPoolIO
+ */
+ThreadPoolIO::ThreadPoolIO(size_t queue_depth, size_t num_threads)
+    : queue_depth_(queue_depth == 0 ? 1 : queue_depth) {
+  for (size_t i = 0; i < num_threads; ++i)
+    threads_.emplace_back([this] { Work(); });
+}
+
+ThreadPoolIO::~ThreadPoolIO() {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    done_cv_.wait(lock, [this] { return in_flight_ == 0; });
+    running_ = false;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_)
+    thread.join();
+}
+
+void ThreadPoolIO::Read(int fd, char *data, size_t size, size_t offset,
+                        IOCallback callback) {
+  Submit(Request{false, fd, data, size, offset, std::move(callback)});
+}
+
+void ThreadPoolIO::Write(int fd, const char *data, size_t size, size_t offset,
+                         IOCallback callback) {
+  Submit(Request{true, fd, const_cast<char *>(data), size, offset,
+                 std::move(callback)});
+}
+
+void ThreadPoolIO::Submit(Request &&request) {
+  std::unique_lock<std::mutex> lock(latch_);
+  done_cv_.wait(lock, [this] { return in_flight_ < queue_depth_; });
+  in_flight_++;
+  queue_.push_back(std::move(request));
+  cv_.notify_one();
+}
+
+/*
+ * Worker loop: do one request at a time to the end, like DiskManager does
+ * for synchronous I/O
+ */
+void ThreadPoolIO::Work() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+    if (queue_.empty())
+      return;
+    Request request = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    ssize_t done = 0;
+    while (size_t(done) < request.size_) {
+      ssize_t rc =
+          request.is_write_
+              ? pwrite(request.fd_, request.data_ + done,
+                       request.size_ - done, request.offset_ + done)
+              : pread(request.fd_, request.data_ + done, request.size_ - done,
+                      request.offset_ + done);
+      if (rc < 0 && errno == EINTR)
+        continue;
+      if (rc < 0)
+        done = -errno;
+      if (rc <= 0)
+        break;
+      done += rc;
+    }
+    request.callback_(done);
+    lock.lock();
+    in_flight_--;
+    done_cv_.notify_all();
+  }
+}
+
+/*
+ * IOUring
+ */
+struct IOUring::Request {
+  bool is_write_;
+  int fd_;
+  struct iovec iov_; // what is left to transfer
+  size_t offset_;    // of iov_
+  size_t done_;      // bytes transferred so far
+  IOCallback callback_;
+};
+
+static int IOUringSetup(unsigned entries, struct io_uring_params *params) {
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int IOUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                        unsigned flags) {
+  return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags,
+                 nullptr, 0);
+}
+
+static int IOUringRegister(int ring_fd, unsigned opcode, void *arg,
+                           unsigned nr_args) {
+  return syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+IOUring::IOUring(size_t queue_depth) : reaper_(nullptr) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = IOUringSetup(queue_depth == 0 ? 1 : queue_depth, &params);
+  if (ring_fd_ < 0)
+    throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+  event_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (event_fd_ < 0 || IOUringRegister(ring_fd_, IORING_REGISTER_EVENTFD,
+                                       &event_fd_, 1) < 0) {
+    int error = errno;
+    if (event_fd_ >= 0)
+      close(event_fd_);
+    close(ring_fd_);
+    throw std::system_error(error, std::generic_category(), "io_uring eventfd");
+  }
+  // the completion queue is larger, so it cannot overflow with at most
+  // entries_ requests in flight
+  entries_ = params.sq_entries;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap)
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  cq_ring_ = single_mmap
+                 ? sq_ring_
+                 : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd_,
+                        IORING_OFF_CQ_RING);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    int error = errno;
+    if (sq_ring_ != MAP_FAILED)
+      munmap(sq_ring_, sq_ring_size_);
+    if (!single_mmap && cq_ring_ != MAP_FAILED)
+      munmap(cq_ring_, cq_ring_size_);
+    if (sqes_ != MAP_FAILED)
+      munmap(sqes_, sqes_size_);
+    close(event_fd_);
+    close(ring_fd_);
+    throw std::system_error(error, std::generic_category(), "io_uring mmap");
+  }
+  char *sq = static_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  char *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+
+  reaper_ = new std::thread([this] { Reap(); });
+}
+
+/*
+ * Wait for the I/Os in flight, then stop the reaper. It is woken up through
+ * the eventfd rather than the ring, which may be refusing submissions
+ */
+IOUring::~IOUring() {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    done_cv_.wait(lock, [this] { return in_flight_ == 0; });
+    running_ = false;
+  }
+  uint64_t wake_up = 1;
+  if (write(event_fd_, &wake_up, sizeof(wake_up)) < 0) {
+    LOG_DEBUG("cannot stop the io_uring reaper: %s", strerror(errno));
+  }
+  reaper_->join();
+  delete reaper_;
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_)
+    munmap(cq_ring_, cq_ring_size_);
+  munmap(sq_ring_, sq_ring_size_);
+  close(event_fd_);
+  close(ring_fd_);
+}
+
+void IOUring::Read(int fd, char *data, size_t size, size_t offset,
+                   IOCallback callback) {
+  Submit(new Request{false, fd, {data, size}, offset, 0, std::move(callback)});
+}
+
+void IOUring::Write(int fd, const char *data, size_t size, size_t offset,
+                    IOCallback callback) {
+  Submit(new Request{
+      true, fd, {const_cast<char *>(data), size}, offset, 0,
+      std::move(callback)});
+}
+
+void IOUring::Submit(Request *request) {
+  std::unique_lock<std::mutex> lock(latch_);
+  done_cv_.wait(lock, [this] { return in_flight_ < entries_; });
+  in_flight_++;
+  Push(request, lock);
+}
+
+/*
+ * Fill in a submission queue entry and hand it to the kernel right away, so
+ * the queue never holds more than one entry that is not submitted yet
+ */
+void IOUring::Push(Request *request, std::unique_lock<std::mutex> &lock) {
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  auto sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = request->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+  sqe->fd = request->fd_;
+  sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+  sqe->len = 1;
+  sqe->off = request->offset_;
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  while (IOUringEnter(ring_fd_, 1, 0, 0) < 0) {
+    if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+      continue;
+    // nothing was submitted, take the entry back
+    int error = errno;
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    LOG_DEBUG("io_uring_enter failed: %s", strerror(error));
+    lock.unlock();
+    request->callback_(-error);
+    delete request;
+    lock.lock();
+    in_flight_--;
+    done_cv_.notify_all();
+    return;
+  }
+}
+
+/*
+ * Reaper loop: sleep on the eventfd until completions are posted, until the
+ * destructor stops it. A completion posted after ReapCompletions looked has
+ * signaled the eventfd already, so the read does not block
+ */
+void IOUring::Reap() {
+  while (true) {
+    ReapCompletions();
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      if (!running_)
+        return;
+    }
+    uint64_t count;
+    if (read(event_fd_, &count, sizeof(count)) < 0 && errno != EINTR) {
+      LOG_DEBUG("eventfd read failed: %s", strerror(errno));
+    }
+  }
+}
+
+/*
+ * A request cut short is submitted again for the rest, until the file ends
+ */
+void IOUring::ReapCompletions() {
+  unsigned head = *cq_head_;
+  unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  while (head != tail) {
+    auto cqe = static_cast<struct io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+    auto request = reinterpret_cast<Request *>(cqe->user_data);
+    int res = cqe->res;
+    __atomic_store_n(cq_head_, ++head, __ATOMIC_RELEASE);
+    if (res > 0 && size_t(res) < request->iov_.iov_len) {
+      request->done_ += res;
+      request->offset_ += res;
+      request->iov_.iov_base =
+          static_cast<char *>(request->iov_.iov_base) + res;
+      request->iov_.iov_len -= res;
+      std::unique_lock<std::mutex> lock(latch_);
+      Push(request, lock);
+      continue;
+    }
+    request->callback_(res < 0 ? res : request->done_ + res);
+    delete request;
+    std::lock_guard<std::mutex> guard(latch_);
+    in_flight_--;
+    done_cv_.notify_all();
+  }
+}
+
+} // namespace cmudb
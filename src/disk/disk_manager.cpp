@@ -1,12 +1,22 @@
 /**
  * disk_manager.cpp
  */
+#include <algorithm>
 #include <assert.h>
+#include <cerrno>
+#include <cstdlib>
 #include <cstring>
+#include <fcntl.h>
 #include <iostream>
+#include <new>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <thread>
+#include <unistd.h>
 
+#include "common/crc32c.h"
+#include "common/exception.h"
 #include "common/logger.h"
 #include "disk/disk_manager.h"
 
@@ -14,13 +24,38 @@ namespace cmudb {
 
 static char *buffer_used = nullptr;
 
+// layout of the file header, the rest of its page is zero
+static const char DB_FILE_MAGIC[8] = {'C', 'M', 'U', 'D', 'B', 'F', 'I', 'L'};
+// version 1 files have no allocation bitmap, version 2 no page checksums
+static const uint32_t DB_FILE_VERSION = 3;
+struct DBFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t page_size;
+  uint32_t pool_size;
+};
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input page_size, pool_size: options of a new database, 0 for default
+ * @input direct_io: bypass the OS page cache for the database file
+ * @input read_only: open an existing database read-only and memory-map it
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), flush_log_(false),
+DiskManager::DiskManager(const std::string &db_file, size_t page_size,
+                         size_t pool_size, bool direct_io, bool read_only)
+    : log_fd_(-1), log_size_(0), file_name_(db_file), db_fd_(-1),
+      db_size_(0), read_only_(read_only), next_page_id_(0),
+      page_size_(page_size == 0 ? PAGE_SIZE : page_size),
+      pool_size_(pool_size == 0 ? BUFFER_POOL_SIZE : pool_size),
+      header_size_(page_size_), num_flushes_(0), flush_log_(false),
       flush_log_f_(nullptr) {
+  if (page_size_ < MIN_PAGE_SIZE || page_size_ > MAX_PAGE_SIZE ||
+      (page_size_ & (page_size_ - 1)) != 0)
+    throw Exception(EXCEPTION_TYPE_OUT_OF_RANGE,
+                    "page size must be a power of two between " +
+                        std::to_string(MIN_PAGE_SIZE) + " and " +
+                        std::to_string(MAX_PAGE_SIZE));
   std::string::size_type n = file_name_.find(".");
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -28,76 +63,544 @@ DiskManager::DiskManager(const std::string &db_file)
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
-  log_io_.open(log_name_,
-               std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app |
-                                std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app |
-                                std::ios::out);
-  }
-
-  db_io_.open(db_file,
-              std::ios::binary | std::ios::in | std::ios::out | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  if (read_only_) {
+    // nothing is created, the log is only read if there is one
+    log_fd_ = open(log_name_.c_str(), O_RDONLY);
+    db_fd_ = open(db_file.c_str(), O_RDONLY);
+  } else {
+    // files are created if they do not exist
+    log_fd_ = open(log_name_.c_str(), O_RDWR | O_CREAT, 0644);
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if ((log_fd_ < 0 && !read_only_) || db_fd_ < 0) {
+    LOG_DEBUG("cannot open %s", db_file.c_str());
+    return;
+  }
+  log_size_ = log_fd_ < 0 ? 0 : GetFileSize(log_fd_);
+  db_size_ = GetFileSize(db_fd_);
+
+  if (db_size_ == 0 && !read_only_) {
+    version_ = DB_FILE_VERSION;
+    WriteFileHeader();
+  } else if (ReadFileHeader()) {
+    if (page_size != 0 && page_size != page_size_) {
+      LOG_DEBUG("page size %zu of existing file kept", page_size_);
+    }
+    // a pool size given explicitly replaces the stored one
+    if (pool_size != 0 && pool_size != pool_size_) {
+      pool_size_ = pool_size;
+      if (!read_only_)
+        WriteFileHeader();
+    }
+  } else {
+    // file written before headers existed
+    LOG_DEBUG("no file header, using default page size");
+    page_size_ = PAGE_SIZE;
+    header_size_ = 0;
+  }
+  // the header is done with buffered I/O, it is smaller than a block
+  if (direct_io && read_only_) {
+    LOG_DEBUG("direct I/O ignored, a read-only file is mapped");
+  } else if (direct_io && !EnableDirectIO()) {
+    LOG_DEBUG("direct I/O not possible, using the page cache");
+  }
+  if (read_only_)
+    MapFile();
+  if (version_ >= 2) {
+    pages_per_bitmap_ = page_size_ * 8;
+    ReadBitmaps();
+  } else if (db_size_ > header_size_) {
+    // without bitmap, every page up to the end of the file is in use
+    next_page_id_ = (db_size_ - header_size_ + page_size_ - 1) / page_size_;
+  }
+  // in older files the end of a page may hold data
+  checksums_ = version_ >= 3;
+}
+
+/**
+ * Map the whole (read-only) file, as long as it is when opened. Pages
+ * appended later are read with pread
+ */
+void DiskManager::MapFile() {
+  if (db_size_ == 0)
+    return;
+  void *map = mmap(nullptr, db_size_, PROT_READ, MAP_SHARED, db_fd_, 0);
+  if (map == MAP_FAILED) {
+    LOG_DEBUG("cannot map %s: %s", file_name_.c_str(), strerror(errno));
+    return;
+  }
+  map_ = static_cast<char *>(map);
+  map_size_ = db_size_;
+}
+
+/**
+ * Hint that pages are about to be read in order, so the kernel reads the
+ * mapping ahead of them
+ */
+void DiskManager::AdviseSequential(page_id_t first_page_id, size_t count) {
+  if (map_ == nullptr || count == 0)
+    return;
+  size_t begin = GetPageOffset(first_page_id);
+  size_t end = std::min(GetPageOffset(first_page_id + count - 1) + page_size_,
+                        map_size_);
+  if (begin >= end)
+    return;
+  num_advised_pages_ += (end - begin + page_size_ - 1) / page_size_;
+  // madvise takes whole system pages
+  size_t system_page = sysconf(_SC_PAGESIZE);
+  begin -= begin % system_page;
+  if (madvise(map_ + begin, end - begin, MADV_SEQUENTIAL) != 0 ||
+      madvise(map_ + begin, end - begin, MADV_WILLNEED) != 0) {
+    LOG_DEBUG("madvise failed: %s", strerror(errno));
+  }
+}
+
+/**
+ * Load the allocation bitmap pages and find the end of the allocated pages
+ */
+void DiskManager::ReadBitmaps() {
+  size_t range_size = (pages_per_bitmap_ + 1) * page_size_;
+  size_t num_bitmaps = (db_size_ - header_size_ + range_size - 1) / range_size;
+  for (size_t i = 0; i < num_bitmaps; ++i) {
+    char *bitmap = NewBitmap();
+    ReadPageData(bitmap, page_size_, GetBitmapOffset(i));
+    bitmaps_.push_back(bitmap);
+  }
+  for (size_t i = num_bitmaps; i-- > 0;) {
+    for (size_t bit = pages_per_bitmap_; bit-- > 0;) {
+      if (bitmaps_[i][bit / 8] & (1 << (bit % 8))) {
+        next_page_id_ = i * pages_per_bitmap_ + bit + 1;
+        return;
+      }
+    }
+  }
+}
+
+/**
+ * A zeroed bitmap page, aligned for direct I/O
+ */
+char *DiskManager::NewBitmap() {
+  void *bitmap;
+  if (posix_memalign(&bitmap, DIRECT_IO_ALIGNMENT, page_size_) != 0)
+    throw std::bad_alloc();
+  memset(bitmap, 0, page_size_);
+  return static_cast<char *>(bitmap);
+}
+
+/**
+ * Mark a page allocated or free and write its bitmap page through, so the
+ * file alone tells which pages are in use. Caller holds alloc_latch_
+ */
+void DiskManager::SetAllocated(page_id_t page_id, bool allocated) {
+  size_t index = page_id / pages_per_bitmap_;
+  size_t bit = page_id % pages_per_bitmap_;
+  while (bitmaps_.size() <= index)
+    bitmaps_.push_back(NewBitmap());
+  if (allocated)
+    bitmaps_[index][bit / 8] |= 1 << (bit % 8);
+  else
+    bitmaps_[index][bit / 8] &= ~(1 << (bit % 8));
+  size_t offset = GetBitmapOffset(index);
+  if (!WritePageData(bitmaps_[index], page_size_, offset)) {
+    LOG_DEBUG("I/O error while writing allocation bitmap");
+    return;
+  }
+  GrowFileSize(db_size_, offset + page_size_);
+  PagesWritten();
+}
+
+bool DiskManager::IsAllocated(page_id_t page_id) const {
+  size_t index = page_id / pages_per_bitmap_;
+  size_t bit = page_id % pages_per_bitmap_;
+  return index < bitmaps_.size() &&
+         (bitmaps_[index][bit / 8] & (1 << (bit % 8))) != 0;
+}
+
+/**
+ * Give the space of the free run around page_id back to the file system
+ * once it spans PUNCH_HOLE_PAGES pages. Runs stop at bitmap pages and at the
+ * end of the allocated pages. Caller holds alloc_latch_
+ */
+void DiskManager::PunchFreeRun(page_id_t page_id) {
+  // extents reserved by an owner keep their preallocated blocks
+  if (reserved_extents_.count(page_id / EXTENT_PAGES) != 0)
+    return;
+  page_id_t range_start = page_id - page_id % pages_per_bitmap_;
+  page_id_t range_end = std::min<page_id_t>(
+      next_page_id_, range_start + page_id_t(pages_per_bitmap_));
+  page_id_t first = page_id;
+  page_id_t last = page_id + 1;
+  while (first > range_start && !IsAllocated(first - 1) &&
+         reserved_extents_.count((first - 1) / EXTENT_PAGES) == 0)
+    first--;
+  while (last < range_end && !IsAllocated(last) &&
+         reserved_extents_.count(last / EXTENT_PAGES) == 0)
+    last++;
+  if (size_t(last - first) < PUNCH_HOLE_PAGES)
+    return;
+  if (fallocate(db_fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                GetPageOffset(first), size_t(last - first) * page_size_) != 0) {
+    LOG_DEBUG("cannot punch hole: %s", strerror(errno));
+  }
+}
+
+/**
+ * O_DIRECT transfers whole blocks at aligned offsets: pages (and the header
+ * before page 0) must be a multiple of the alignment. Linux lets the flag
+ * be set on the open descriptor; file systems without direct I/O refuse it
+ */
+bool DiskManager::EnableDirectIO() {
+  if (page_size_ % DIRECT_IO_ALIGNMENT != 0 ||
+      header_size_ % DIRECT_IO_ALIGNMENT != 0)
+    return false;
+  int flags = fcntl(db_fd_, F_GETFL);
+  if (flags < 0 || fcntl(db_fd_, F_SETFL, flags | O_DIRECT) < 0)
+    return false;
+  direct_io_ = true;
+  return true;
+}
+
+/**
+ * Read page size and pool size from the file header
+ * @return: false if the file has no header
+ */
+bool DiskManager::ReadFileHeader() {
+  DBFileHeader header;
+  if (ReadAt(db_fd_, reinterpret_cast<char *>(&header), sizeof(header), 0) <
+          sizeof(header) ||
+      memcmp(header.magic, DB_FILE_MAGIC, sizeof(DB_FILE_MAGIC)) != 0)
+    return false;
+  if (header.version < 1 || header.version > DB_FILE_VERSION ||
+      header.page_size < MIN_PAGE_SIZE ||
+      header.page_size > MAX_PAGE_SIZE)
+    throw Exception(EXCEPTION_TYPE_MISMATCH_TYPE,
+                    "unsupported database file " + file_name_);
+  page_size_ = header.page_size;
+  pool_size_ = header.pool_size;
+  header_size_ = page_size_;
+  version_ = header.version;
+  return true;
+}
+
+/**
+ * Write the file header, padded to one page
+ */
+void DiskManager::WriteFileHeader() {
+  std::string block(header_size_, '\0');
+  DBFileHeader header;
+  memcpy(header.magic, DB_FILE_MAGIC, sizeof(DB_FILE_MAGIC));
+  header.version = version_;
+  header.page_size = page_size_;
+  header.pool_size = pool_size_;
+  memcpy(&block[0], &header, sizeof(header));
+  if (!WriteAt(db_fd_, block.data(), block.size(), 0)) {
+    LOG_DEBUG("I/O error while writing file header");
+    return;
   }
+  GrowFileSize(db_size_, block.size());
 }
 
 DiskManager::~DiskManager() {
-  db_io_.close();
-  log_io_.close();
+  // waits for the asynchronous I/O in flight
+  delete async_io_;
+  for (auto bitmap : bitmaps_)
+    free(bitmap);
+  if (map_ != nullptr)
+    munmap(map_, map_size_);
+  if (db_fd_ >= 0)
+    close(db_fd_);
+  if (log_fd_ >= 0)
+    close(log_fd_);
+}
+
+/**
+ * Allocate an aligned buffer for count pages, freed with free()
+ */
+char *DiskManager::AllocatePages(size_t count) {
+  void *buffer;
+  if (posix_memalign(&buffer, DIRECT_IO_ALIGNMENT, count * page_size_) != 0)
+    throw std::bad_alloc();
+  return static_cast<char *>(buffer);
+}
+
+/**
+ * Copy a page to be written into copy, with its checksum in the last
+ * PAGE_CHECKSUM_SIZE bytes. The frame itself is left alone: its writers only
+ * hold its read latch
+ */
+void DiskManager::CopyWithChecksum(const char *page_data, char *copy) {
+  size_t size = page_size_ - PAGE_CHECKSUM_SIZE;
+  memcpy(copy, page_data, size);
+  uint32_t checksum = Crc32c(copy, size);
+  memcpy(copy + size, &checksum, PAGE_CHECKSUM_SIZE);
+}
+
+/**
+ * Check a page read from disk against its checksum. Pages never written
+ * (zero-filled or punched out) have none
+ */
+bool DiskManager::VerifyChecksum(page_id_t page_id, const char *page_data) {
+  if (!checksums_ || !verify_checksums_)
+    return true;
+  uint32_t checksum;
+  memcpy(&checksum, page_data + page_size_ - PAGE_CHECKSUM_SIZE,
+         PAGE_CHECKSUM_SIZE);
+  if (checksum == Crc32c(page_data, page_size_ - PAGE_CHECKSUM_SIZE))
+    return true;
+  if (checksum == 0 &&
+      std::all_of(page_data, page_data + page_size_ - PAGE_CHECKSUM_SIZE,
+                  [](char c) { return c == 0; }))
+    return true;
+  checksum_failures_++;
+  LOG_DEBUG("checksum mismatch in page %d", page_id);
+  return false;
 }
 
 /**
  * Write the contents of the specified page into disk file
+ * Positional I/O, so threads writing different pages do not interfere
  */
-void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = page_id * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+bool DiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  size_t offset = GetPageOffset(page_id);
+  bool ok;
+  if (checksums_) {
+    char *copy = AllocatePages(1);
+    CopyWithChecksum(page_data, copy);
+    ok = WriteAt(db_fd_, copy, page_size_, offset);
+    free(copy);
+  } else {
+    ok = WritePageData(page_data, page_size_, offset);
+  }
+  if (!ok) {
     LOG_DEBUG("I/O error while writing");
-    return;
+    return false;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  GrowFileSize(db_size_, offset + page_size_);
+  PagesWritten();
+  return true;
 }
 
 /**
  * Read the contents of the specified page into the given memory area
+ * Return false on I/O error or if it fails its checksum. A page allocated
+ * but never written lies past the end of the file and reads as zeroes
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
+bool DiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  size_t offset = GetPageOffset(page_id);
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset >= db_size_) {
+    LOG_DEBUG("Read beyond the end of the file");
+    memset(page_data, 0, page_size_);
+    return true;
+  }
+  size_t read_count = ReadPageData(page_data, page_size_, offset);
+  // the file was at least db_size_ long, a read stopping short of it failed
+  if (read_count < page_size_ && offset + read_count < db_size_) {
     LOG_DEBUG("I/O error while reading");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    return false;
+  }
+  // if file ends before reading a whole page
+  if (read_count < page_size_) {
+    LOG_DEBUG("Read less than a page");
+    // std::cerr << "Read less than a page" << std::endl;
+    memset(page_data + read_count, 0, page_size_ - read_count);
+  }
+  return VerifyChecksum(page_id, page_data);
+}
+
+/**
+ * Read a run of consecutive pages into the given memory area
+ */
+size_t DiskManager::ReadPages(page_id_t first_page_id, size_t count,
+                              char *page_data, std::vector<bool> *valid) {
+  size_t segment = GetSegmentLength(first_page_id, count);
+  if (segment < count) {
+    // the pages are not contiguous in the file across a bitmap page
+    size_t read_count = ReadPages(first_page_id, segment, page_data, valid);
+    return read_count + ReadPages(first_page_id + segment, count - segment,
+                                  page_data + segment * page_size_, valid);
+  }
+  size_t size = count * page_size_;
+  AdviseSequential(first_page_id, count);
+  size_t read_count =
+      ReadPageData(page_data, size, GetPageOffset(first_page_id));
+  if (read_count < size)
+    memset(page_data + read_count, 0, size - read_count);
+  for (size_t i = 0; i < read_count / page_size_; ++i) {
+    bool ok = VerifyChecksum(first_page_id + i, page_data + i * page_size_);
+    if (valid != nullptr)
+      valid->push_back(ok);
+  }
+  return read_count / page_size_;
+}
+
+/**
+ * Write a run of consecutive pages, each from its own buffer, with one
+ * pwritev (more if it is cut short). With checksums the pages are copied
+ * into one buffer, written with a single pwrite
+ */
+bool DiskManager::WritePages(page_id_t first_page_id,
+                             const std::vector<const char *> &page_data) {
+  size_t segment = GetSegmentLength(first_page_id, page_data.size());
+  if (segment < page_data.size()) {
+    // the pages are not contiguous in the file across a bitmap page
+    bool ok = WritePages(first_page_id,
+                         std::vector<const char *>(
+                             page_data.begin(), page_data.begin() + segment));
+    return WritePages(first_page_id + segment,
+                      std::vector<const char *>(page_data.begin() + segment,
+                                                page_data.end())) &&
+           ok;
+  }
+  off_t offset = GetPageOffset(first_page_id);
+  if (checksums_) {
+    char *run = AllocatePages(page_data.size());
+    for (size_t i = 0; i < page_data.size(); ++i)
+      CopyWithChecksum(page_data[i], run + i * page_size_);
+    bool ok = WriteAt(db_fd_, run, page_data.size() * page_size_, offset);
+    free(run);
+    if (!ok) {
+      LOG_DEBUG("I/O error while writing");
+      return false;
     }
+    GrowFileSize(db_size_, offset + page_data.size() * page_size_);
+    PagesWritten();
+    return true;
+  }
+  for (auto data : page_data) {
+    if (!IsAligned(data)) {
+      bool ok = true;
+      for (size_t i = 0; i < page_data.size(); ++i)
+        ok = WritePage(first_page_id + i, page_data[i]) && ok;
+      return ok;
+    }
+  }
+  std::vector<struct iovec> iov(page_data.size());
+  for (size_t i = 0; i < page_data.size(); ++i) {
+    iov[i].iov_base = const_cast<char *>(page_data[i]);
+    iov[i].iov_len = page_size_;
+  }
+  size_t next = 0;
+  while (next < iov.size()) {
+    ssize_t written = pwritev(db_fd_, &iov[next], iov.size() - next, offset);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    offset += written;
+    // skip the buffers written in full, then the written part of the next
+    while (next < iov.size() && size_t(written) >= iov[next].iov_len)
+      written -= iov[next++].iov_len;
+    if (next < iov.size()) {
+      iov[next].iov_base = static_cast<char *>(iov[next].iov_base) + written;
+      iov[next].iov_len -= written;
+    }
+  }
+  GrowFileSize(db_size_, offset);
+  PagesWritten();
+  return true;
+}
+
+/**
+ * Called after page writes: sync them right away under the PER_WRITE policy,
+ * otherwise leave them to the next SyncPages
+ */
+void DiskManager::PagesWritten() {
+  if (sync_policy_ == SyncPolicy::PER_WRITE)
+    SyncFile();
+  else
+    unsynced_ = true;
+}
+
+void DiskManager::SyncFile() {
+  if (fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+    return;
+  }
+  num_syncs_++;
+}
+
+/**
+ * Flush the data of the db file to stable storage; metadata such as the
+ * modification time is not waited for. One sync covers every page written
+ * since the last one (by eviction, the background writer, a flush), and
+ * none is done if there is no such page. The OS policy never syncs
+ */
+void DiskManager::SyncPages() {
+  if (sync_policy_ == SyncPolicy::OS)
+    return;
+  // a write finishing meanwhile is either covered or marks the file again
+  if (unsynced_.exchange(false))
+    SyncFile();
+}
+
+AsyncIO *DiskManager::GetAsyncIO() {
+  std::call_once(async_io_flag_, [this] { async_io_ = AsyncIO::Create(); });
+  return async_io_;
+}
+
+bool DiskManager::IsIOUring() { return GetAsyncIO()->IsIOUring(); }
+
+/**
+ * Queue a read of the specified page, done(true) is called once it is in
+ * page_data
+ */
+void DiskManager::ReadPageAsync(page_id_t page_id, char *page_data,
+                                std::function<void(bool)> done) {
+  // a copy from the mapping is cheaper than queueing a read
+  if (!IsAligned(page_data) || map_ != nullptr) {
+    done(ReadPage(page_id, page_data));
+    return;
+  }
+  size_t page_size = page_size_;
+  GetAsyncIO()->Read(db_fd_, page_data, page_size, GetPageOffset(page_id),
+                     [this, page_id, page_data, page_size,
+                      done](ssize_t read_count) {
+                       if (read_count < 0) {
+                         LOG_DEBUG("I/O error while reading");
+                         done(false);
+                         return;
+                       }
+                       // the file ends before the page
+                       if (size_t(read_count) < page_size)
+                         memset(page_data + read_count, 0,
+                                page_size - read_count);
+                       done(VerifyChecksum(page_id, page_data));
+                     });
+}
+
+/**
+ * Queue a write of the specified page, done(true) is called once it is in
+ * the file
+ */
+void DiskManager::WritePageAsync(page_id_t page_id, const char *page_data,
+                                 std::function<void(bool)> done) {
+  if (!checksums_ && !IsAligned(page_data)) {
+    done(WritePage(page_id, page_data));
+    return;
   }
+  // the copy lives until the write completes
+  char *copy = nullptr;
+  if (checksums_) {
+    copy = AllocatePages(1);
+    CopyWithChecksum(page_data, copy);
+    page_data = copy;
+  }
+  size_t end = GetPageOffset(page_id) + page_size_;
+  GetAsyncIO()->Write(db_fd_, page_data, page_size_, GetPageOffset(page_id),
+                      [this, end, copy, done](ssize_t written) {
+                        free(copy);
+                        if (written < 0) {
+                          LOG_DEBUG("I/O error while writing");
+                          done(false);
+                          return;
+                        }
+                        GrowFileSize(db_size_, end);
+                        PagesWritten();
+                        done(true);
+                      });
 }
 
 /**
@@ -120,16 +623,17 @@ void DiskManager::WriteLog(char *log_data, int size) {
            std::future_status::ready);
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
+  // sequence write, there is a single log writer
+  if (!WriteAt(log_fd_, log_data, size, log_size_)) {
     LOG_DEBUG("I/O error while writing log");
     return;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  log_size_ += size;
+  // needs to sync to keep disk file durable
+  if (fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+    return;
+  }
   flush_log_ = false;
 }
 
@@ -139,35 +643,128 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * @return: false means already reach the end
  */
 bool DiskManager::ReadLog(char *log_data, int size, int offset) {
-  if (offset >= GetFileSize(log_name_)) {
+  if (offset < 0 || size_t(offset) >= log_size_) {
     // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
+    // LOG_DEBUG("file size is %zu", size_t(log_size_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
+  size_t read_count = ReadAt(log_fd_, log_data, size, offset);
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
-  if (read_count < size) {
-    log_io_.clear();
+  if (read_count < size_t(size))
     memset(log_data + read_count, 0, size - read_count);
-  }
 
   return true;
 }
 
+/**
+ * First page from page_id on that is not allocated. Caller holds
+ * alloc_latch_
+ */
+page_id_t DiskManager::SkipAllocated(page_id_t page_id) const {
+  while (IsAllocated(page_id)) {
+    // skip bytes of the bitmap with every page allocated
+    size_t bit = page_id % pages_per_bitmap_;
+    if (bit % 8 == 0 &&
+        static_cast<unsigned char>(
+            bitmaps_[page_id / pages_per_bitmap_][bit / 8]) == 0xff)
+      page_id += 8;
+    else
+      page_id++;
+  }
+  return page_id;
+}
+
+/**
+ * Make a fully free extent the current extent of owner and preallocate its
+ * blocks; return its first page. Caller holds alloc_latch_
+ */
+page_id_t DiskManager::ReserveExtent(page_id_t owner) {
+  size_t extent = first_free_ / EXTENT_PAGES;
+  while (true) {
+    page_id_t first = extent * EXTENT_PAGES;
+    // an extent lies within one bitmap page, its bits are whole bytes
+    size_t index = first / pages_per_bitmap_;
+    if (reserved_extents_.count(extent) == 0 &&
+        (index >= bitmaps_.size() ||
+         std::all_of(
+             bitmaps_[index] + first % pages_per_bitmap_ / 8,
+             bitmaps_[index] + first % pages_per_bitmap_ / 8 + EXTENT_PAGES / 8,
+             [](char bits) { return bits == 0; })))
+      break;
+    extent++;
+  }
+  auto it = extents_.find(owner);
+  if (it != extents_.end())
+    reserved_extents_.erase(it->second);
+  extents_[owner] = extent;
+  reserved_extents_.insert(extent);
+  page_id_t first = extent * EXTENT_PAGES;
+  // blocks only, the file size still tells which pages were written
+  if (fallocate(db_fd_, FALLOC_FL_KEEP_SIZE, GetPageOffset(first),
+                EXTENT_PAGES * page_size_) != 0) {
+    LOG_DEBUG("cannot preallocate extent: %s", strerror(errno));
+  }
+  return first;
+}
+
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Pages of an owner (e.g. the first page id of a table heap) come from an
+ * extent of EXTENT_PAGES pages reserved for it, so that they are sequential
+ * in the file. Other pages reuse the lowest free page outside reserved
+ * extents, the file only grows when there is none.
+ * Files without bitmap just keep an increasing counter
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage(page_id_t owner) {
+  if (read_only_)
+    return INVALID_PAGE_ID;
+  if (pages_per_bitmap_ == 0)
+    return next_page_id_++;
+  std::lock_guard<std::mutex> guard(alloc_latch_);
+  first_free_ = SkipAllocated(first_free_);
+  page_id_t page_id = INVALID_PAGE_ID;
+  if (owner == INVALID_PAGE_ID) {
+    page_id = first_free_;
+    while (reserved_extents_.count(page_id / EXTENT_PAGES) != 0)
+      page_id = SkipAllocated((page_id / EXTENT_PAGES + 1) * EXTENT_PAGES);
+  } else {
+    auto it = extents_.find(owner);
+    if (it != extents_.end()) {
+      page_id_t first = it->second * EXTENT_PAGES;
+      page_id = SkipAllocated(first);
+      if (page_id >= first + EXTENT_PAGES)
+        page_id = INVALID_PAGE_ID;
+    }
+    if (page_id == INVALID_PAGE_ID)
+      page_id = ReserveExtent(owner);
+  }
+  SetAllocated(page_id, true);
+  if (page_id >= next_page_id_)
+    next_page_id_ = page_id + 1;
+  return page_id;
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
+ * The page is marked free in the bitmap, to be reused by AllocatePage; large
+ * free runs are punched out of the file. Without bitmap only the most
+ * recently allocated page can be given back (e.g. when buffer pool has no
+ * frame left for it), so its id is handed out again
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-  return;
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  if (read_only_)
+    return;
+  if (pages_per_bitmap_ == 0) {
+    page_id_t expected = page_id + 1;
+    next_page_id_.compare_exchange_strong(expected, page_id);
+    return;
+  }
+  std::lock_guard<std::mutex> guard(alloc_latch_);
+  if (page_id < 0 || page_id >= next_page_id_ || !IsAllocated(page_id))
+    return;
+  SetAllocated(page_id, false);
+  first_free_ = std::min(first_free_, page_id);
+  PunchFreeRun(page_id);
 }
 
 /**
@@ -181,12 +778,91 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
 /**
- * Private helper function to get disk file size
+ * Private helper function to get disk file size, only asked when the file
+ * is opened: the size is then kept up to date by the writes
  */
-int DiskManager::GetFileSize(const std::string &file_name) {
+size_t DiskManager::GetFileSize(int fd) {
   struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? stat_buf.st_size : -1;
+  int rc = fstat(fd, &stat_buf);
+  return rc == 0 ? stat_buf.st_size : 0;
+}
+
+/**
+ * Raise a cached file size to end, if it is smaller
+ */
+void DiskManager::GrowFileSize(std::atomic<size_t> &file_size, size_t end) {
+  size_t size = file_size;
+  while (size < end && !file_size.compare_exchange_weak(size, end))
+    ;
+}
+
+/**
+ * Read pages of the data file. Pages and their offsets are always aligned
+ * for direct I/O, a caller's buffer may not be (e.g. on the stack)
+ */
+size_t DiskManager::ReadPageData(char *data, size_t size, size_t offset) {
+  // a read-only file is served from the mapping, without a system call
+  if (offset + size <= map_size_) {
+    memcpy(data, map_ + offset, size);
+    return size;
+  }
+  if (IsAligned(data))
+    return ReadAt(db_fd_, data, size, offset);
+  void *buffer;
+  if (posix_memalign(&buffer, DIRECT_IO_ALIGNMENT, size) != 0)
+    throw std::bad_alloc();
+  size_t read_count = ReadAt(db_fd_, static_cast<char *>(buffer), size, offset);
+  memcpy(data, buffer, read_count);
+  free(buffer);
+  return read_count;
+}
+
+bool DiskManager::WritePageData(const char *data, size_t size,
+                                size_t offset) {
+  if (IsAligned(data))
+    return WriteAt(db_fd_, data, size, offset);
+  void *buffer;
+  if (posix_memalign(&buffer, DIRECT_IO_ALIGNMENT, size) != 0)
+    throw std::bad_alloc();
+  memcpy(buffer, data, size);
+  bool ok = WriteAt(db_fd_, static_cast<char *>(buffer), size, offset);
+  free(buffer);
+  return ok;
+}
+
+/**
+ * pread until size bytes are read or the file ends
+ * @return: number of bytes read
+ */
+size_t DiskManager::ReadAt(int fd, char *data, size_t size, size_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t rc = pread(fd, data + done, size - done, offset + done);
+    if (rc < 0 && errno == EINTR)
+      continue;
+    if (rc <= 0)
+      break;
+    done += rc;
+  }
+  return done;
+}
+
+/**
+ * pwrite all of data
+ * @return: false on I/O error
+ */
+bool DiskManager::WriteAt(int fd, const char *data, size_t size,
+                          size_t offset) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t rc = pwrite(fd, data + done, size - done, offset + done);
+    if (rc < 0 && errno == EINTR)
+      continue;
+    if (rc < 0)
+      return false;
+    done += rc;
+  }
+  return true;
 }
 
 } // namespace cmudb
@@ -0,0 +1,123 @@
+#include <cassert>
+#include <cstdint>
+
+#include "hash/linear_probe_hash_table.h"
+#include "page/page.h"
+
+namespace cmudb
+{
+
+template <typename K, typename V>
+LinearProbeHashTable<K, V>::LinearProbeHashTable(size_t max_entries,
+                                                 const K &empty_key)
+    : empty_key_(empty_key), size_(0)
+{
+    size_t capacity = 2;
+    while (capacity < 2 * max_entries)
+        capacity <<= 1;
+    mask_ = capacity - 1;
+    slots_ = new Slot[capacity];
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        slots_[i].key.store(empty_key_, std::memory_order_relaxed);
+        slots_[i].value.store(V(), std::memory_order_relaxed);
+    }
+}
+
+template <typename K, typename V>
+LinearProbeHashTable<K, V>::~LinearProbeHashTable()
+{
+    delete[] slots_;
+}
+
+/*
+ * Fibonacci hashing, so that consecutive page ids (or ids that all fall into
+ * the same buffer pool instance) still spread over the whole table
+ */
+template <typename K, typename V>
+size_t LinearProbeHashTable<K, V>::HashKey(const K &key) const
+{
+    uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(h >> 32) & mask_;
+}
+
+/*
+ * lookup function to find value associate with input key, lock-free
+ */
+template <typename K, typename V>
+bool LinearProbeHashTable<K, V>::Find(const K &key, V &value)
+{
+    for (size_t i = HashKey(key);; i = (i + 1) & mask_)
+    {
+        K slot_key = slots_[i].key.load(std::memory_order_acquire);
+        if (slot_key == empty_key_)
+            return false;
+        if (slot_key == key)
+        {
+            value = slots_[i].value.load(std::memory_order_acquire);
+            return true;
+        }
+    }
+}
+
+/*
+ * insert <key,value> entry in hash table, the caller serializes writers.
+ * The value is published before the key so a reader that sees the key reads
+ * a value that was stored for it
+ */
+template <typename K, typename V>
+void LinearProbeHashTable<K, V>::Insert(const K &key, const V &value)
+{
+    assert(key != empty_key_);
+    assert(size_ < GetCapacity() - 1);
+    size_t i = HashKey(key);
+    while (slots_[i].key.load(std::memory_order_relaxed) != empty_key_)
+        i = (i + 1) & mask_;
+    slots_[i].value.store(value, std::memory_order_release);
+    slots_[i].key.store(key, std::memory_order_release);
+    size_++;
+}
+
+/*
+ * delete <key,value> entry in hash table, the caller serializes writers.
+ * Entries after the hole whose home slot does not lie between the hole and
+ * themselves are shifted back into it, which keeps every probe sequence
+ * unbroken without tombstones
+ */
+template <typename K, typename V>
+bool LinearProbeHashTable<K, V>::Remove(const K &key)
+{
+    size_t hole = HashKey(key);
+    for (;; hole = (hole + 1) & mask_)
+    {
+        K slot_key = slots_[hole].key.load(std::memory_order_relaxed);
+        if (slot_key == empty_key_)
+            return false;
+        if (slot_key == key)
+            break;
+    }
+    for (size_t i = (hole + 1) & mask_;; i = (i + 1) & mask_)
+    {
+        K slot_key = slots_[i].key.load(std::memory_order_relaxed);
+        if (slot_key == empty_key_)
+            break;
+        size_t home = HashKey(slot_key);
+        // distance from home to i, and from home to hole, along the probe
+        if (((i - home) & mask_) >= ((i - hole) & mask_))
+        {
+            slots_[hole].value.store(
+                slots_[i].value.load(std::memory_order_relaxed),
+                std::memory_order_release);
+            slots_[hole].key.store(slot_key, std::memory_order_release);
+            hole = i;
+        }
+    }
+    slots_[hole].key.store(empty_key_, std::memory_order_release);
+    size_--;
+    return true;
+}
+
+template class LinearProbeHashTable<page_id_t, Page *>;
+// test purpose
+template class LinearProbeHashTable<int, int>;
+} // namespace cmudb
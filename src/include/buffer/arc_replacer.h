@@ -0,0 +1,98 @@
+/**
+ * arc_replacer.h
+ *
+ * Functionality: Adaptive Replacement Cache. Resident pages live either in T1
+ * (seen once recently) or T2 (seen at least twice); ghost lists B1/B2 keep the
+ * ids of pages recently evicted from T1/T2. A miss on a page found in B1 means
+ * T1 was too small, a miss found in B2 means T2 was too small, and the target
+ * size p of T1 is moved accordingly, so the cache tunes itself between
+ * recency (scans) and frequency (point lookups) at runtime.
+ *
+ * The buffer pool asks for a victim before it tells the replacer which page
+ * is coming in, so a ghost hit adapts p for the next replacement rather than
+ * the one that made room for the page.
+ *
+ * A page of T1 accessed again within a correlated reference period (counted
+ * in accesses to the replacer) of its previous access stays in T1, so a scan
+ * that pins its page once per tuple does not promote the page to T2.
+ */
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace cmudb {
+
+template <typename T> class ARCReplacer : public Replacer<T> {
+public:
+  // capacity: number of frames managed by this replacer. correlation_period:
+  // an access at most that many accesses after the previous one of the same
+  // page does not count as seeing it again, 0 counts them all
+  explicit ARCReplacer(size_t capacity, size_t correlation_period = 0);
+
+  ~ARCReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Victim(T &value, const std::function<bool(const T &)> &can_evict);
+
+  bool Erase(const T &value);
+
+  bool Evict(const T &value);
+
+  size_t Size();
+
+  void RecordAccess(const T &value);
+
+  void Remove(const T &value);
+
+  void GetVictimCandidates(std::vector<T> &candidates, size_t max_values);
+
+  void SetCapacity(size_t capacity);
+
+  // adaptation state, for diagnostics
+  size_t GetTargetT1Size();
+  size_t GetListSize(int list);
+
+  enum ListType { T1 = 0, T2, B1, B2 };
+
+private:
+  struct Entry {
+    ListType list;
+    std::list<page_id_t>::iterator pos;
+    T value;
+    bool evictable;
+    size_t last_access; // access_count_ when it was last accessed
+  };
+
+  // page id a value stands for
+  static page_id_t GetKey(const T &value);
+  // record an access while holding mtx
+  Entry &Access(const T &value);
+  // move entry of key to the most recently used end of list
+  void MoveTo(page_id_t key, Entry &entry, ListType list);
+  // least recently used evictable page of a resident list accepted by
+  // can_evict (if not empty), or nullptr
+  Entry *FindVictim(ListType list, page_id_t &key,
+                    const std::function<bool(const T &)> &can_evict);
+  // bound the ghost lists to the capacity
+  void TrimGhosts();
+
+  size_t capacity_;
+  size_t correlation_period_;
+  size_t access_count_;
+  size_t target_t1_size_; // p in the paper
+  size_t size_;           // number of evictable pages
+  std::list<page_id_t> lists_[4]; // most recently used first
+  std::unordered_map<page_id_t, Entry> entries_;
+  std::mutex mtx;
+};
+
+} // namespace cmudb
@@ -0,0 +1,45 @@
+/*
+ * buffer_access_strategy.h
+ *
+ * Functionality: Lets a large sequential scan or bulk load confine itself to
+ * a small ring of frames that it recycles for its own misses, instead of
+ * asking the replacer for victims and pushing everybody else's hot pages out
+ * of the buffer pool (like the buffer rings of PostgreSQL). The ring is split
+ * over the buffer pool instances; each part is only touched under the latch
+ * of its instance, so a strategy may be shared by threads.
+ */
+
+#pragma once
+#include <vector>
+
+#include "common/config.h"
+#include "page/page.h"
+
+namespace cmudb {
+// the frames of one instance recycled by a strategy
+struct BufferRing {
+  std::vector<Page *> frames_;      // in the order they are recycled
+  std::vector<page_id_t> page_ids_; // page each frame was taken for
+  size_t capacity_ = 0;
+  size_t next_ = 0; // slot recycled by the next miss once the ring is full
+};
+
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+public:
+  // ring_size frames in total, spread over num_instances partitions
+  BufferAccessStrategy(size_t num_instances, size_t ring_size)
+      : rings_(num_instances) {
+    for (size_t i = 0; i < num_instances; ++i) {
+      rings_[i].capacity_ = ring_size / num_instances +
+                            (i < ring_size % num_instances ? 1 : 0);
+      if (rings_[i].capacity_ == 0)
+        rings_[i].capacity_ = 1;
+    }
+  }
+
+private:
+  std::vector<BufferRing> rings_; // one per buffer pool instance
+};
+} // namespace cmudb
@@ -0,0 +1,185 @@
+/*
+ * buffer_pool_instance.h
+ *
+ * Functionality: One partition of the buffer pool. Each instance owns a slice
+ * of the frames together with its own page table, replacer, free list and
+ * latch, so that threads working on pages of different instances never
+ * contend with each other. BufferPoolManager routes every page id to exactly
+ * one instance.
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "disk/disk_manager.h"
+#include "hash/linear_probe_hash_table.h"
+#include "logging/log_manager.h"
+#include "page/page.h"
+
+namespace cmudb {
+class BufferPoolInstance {
+public:
+  BufferPoolInstance(size_t pool_size, DiskManager *disk_manager,
+                     LogManager *log_manager = nullptr,
+                     ReplacerType replacer_type = ReplacerType::LRU);
+
+  ~BufferPoolInstance();
+
+  // a miss recycles a frame of ring, if not nullptr
+  Page *FetchPage(page_id_t page_id, BufferRing *ring = nullptr);
+
+  // pin the page only if it is resident and readable, never does disk I/O
+  Page *FetchResidentPage(page_id_t page_id);
+
+  // bring the page into the pool unpinned, if it is not resident yet. Once
+  // it is, on_read (if given) is called with the page pinned
+  void PrefetchPage(page_id_t page_id, BufferRing *ring = nullptr,
+                    std::function<void(Page *)> on_read = nullptr);
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+  bool FlushPage(page_id_t page_id);
+
+  // page_id has already been allocated by the caller
+  Page *NewPage(page_id_t page_id, BufferRing *ring = nullptr);
+
+  bool DeletePage(page_id_t page_id);
+
+  // write back up to max_pages dirty unpinned pages that are next in line
+  // for eviction, return the number of pages written
+  size_t WriteBackDirtyPages(size_t max_pages);
+
+  // append the ids of the dirty pages, for a flush of the whole pool
+  void GetDirtyPageIds(std::vector<page_id_t> &page_ids);
+  // pin a dirty page and mark it clean, for the caller to write back and
+  // unpin. Return nullptr if it is not resident and dirty any more
+  Page *PinDirtyPage(page_id_t page_id);
+
+  // write-ahead logging: before pp is written back, flush the log up to the
+  // LSN of pp if it is not on disk yet. false if it could not be, then pp
+  // must not be written
+  bool ForceLog(Page *pp);
+
+  // fraction of the frames in use (including those still to be retired)
+  // holding a dirty page
+  double GetDirtyRatio();
+
+  // append the resident page ids, hottest first: pinned pages, then the
+  // others in reverse order of eviction
+  void GetResidentPages(std::vector<page_id_t> &page_ids);
+  // warm-up: claim a free frame for a page the caller is about to read, so
+  // fetchers of the page wait for the read. Return nullptr if the page is
+  // resident, or if there is no free frame left (then full is set)
+  Page *ClaimFreeFrame(page_id_t page_id, bool &full);
+  // put the page read by the caller into the frame claimed for it,
+  // unpinned; page_data is nullptr if the read failed
+  void WarmPage(Page *pp, page_id_t page_id, const char *page_data);
+
+  // change the number of frames in use, within the room reserved for the
+  // pool to grow (false if it is out of huge pages to map). Frames given up
+  // are released by ReleaseFrames, which returns how many of them are still
+  // pinned
+  bool Resize(size_t pool_size);
+  size_t ReleaseFrames();
+
+  inline size_t GetPoolSize() const { return pool_size_; }
+  inline size_t GetMaxPoolSize() const { return max_frames_; }
+  inline size_t GetHitCount() const {
+    return counters_.Get(BufferPoolEvent::HIT);
+  }
+  inline size_t GetMissCount() const {
+    return counters_.Get(BufferPoolEvent::MISS);
+  }
+  inline size_t GetWriteBackCount() const {
+    return counters_.Get(BufferPoolEvent::WRITE_BACK);
+  }
+  inline size_t GetPrefetchCount() const {
+    return counters_.Get(BufferPoolEvent::PREFETCH);
+  }
+  inline size_t GetLogForceCount() const {
+    return counters_.Get(BufferPoolEvent::LOG_FORCE);
+  }
+  inline BufferPoolStats GetStats() const { return counters_.Snapshot(); }
+  // time a guard spent waiting for the latch of a page of this instance
+  inline void
+  RecordPageLatchWait(std::chrono::steady_clock::duration latency) {
+    counters_.page_latch_wait_.Record(latency);
+  }
+  inline Replacer<Page *> *GetReplacer() const { return replacer_; }
+
+private:
+  // pin a frame found without holding latch_, if it still holds page_id
+  bool TryPinPage(Page *pp, page_id_t page_id);
+  // look up a resident page, waiting out any disk I/O in flight on its frame
+  bool FindPage(page_id_t page_id, Page *&pp,
+                std::unique_lock<std::mutex> &lock);
+  // find a frame for a new resident page, either from free list or replacer
+  Page *GetVictimPage(std::unique_lock<std::mutex> &lock);
+  // with logging on, a frame among the next victims that can be evicted
+  // without forcing the log, or nullptr
+  Page *GetLoggedVictimPage(std::unique_lock<std::mutex> &lock);
+  // the log has to be flushed before pp is written back
+  inline bool NeedsLogForce(Page *pp) {
+    return ENABLE_LOGGING && log_manager_ != nullptr &&
+           pp->GetLSN() > log_manager_->GetPersistentLSN();
+  }
+  // find a frame for a new resident page in a buffer ring
+  Page *GetRingVictimPage(BufferRing *ring, page_id_t page_id,
+                          std::unique_lock<std::mutex> &lock);
+  // take a frame for page_id and mark it as having I/O in flight
+  Page *InstallPage(page_id_t page_id, page_id_t &victim_page_id,
+                    bool &victim_dirty, std::unique_lock<std::mutex> &lock,
+                    BufferRing *ring);
+  // write back the old content of a frame taken by InstallPage, undo
+  // InstallPage if that fails
+  bool EvictVictim(Page *pp, page_id_t victim_page_id, bool victim_dirty,
+                   std::unique_lock<std::mutex> &lock);
+  // take latch_, recording the time waited for it
+  std::unique_lock<std::mutex> LockLatch();
+  // disk I/O of a frame, recording its latency. The read fails if the
+  // page cannot be read or fails its checksum
+  bool ReadPageData(page_id_t page_id, Page *pp);
+  bool WritePageData(page_id_t page_id, Page *pp);
+  // clear the I/O flag of a frame and wake up waiters
+  void FinishIO(Page *pp);
+  // FinishIO for a frame read in the background, which is unpinned too
+  void FinishBackgroundIO(Page *pp);
+  // unmap a page whose read failed and free its frame
+  void AbortIO(Page *pp, page_id_t page_id);
+  // read of PrefetchPage into a frame taken by InstallPage
+  void ReadPageAsync(Page *pp, page_id_t page_id,
+                     std::function<void(Page *)> on_read);
+
+  std::atomic<size_t> pool_size_; // number of pages in this instance
+  size_t max_frames_; // frames reserved to grow into, the ones from
+                      // pool_size_ on are retired or about to be
+  size_t frames_in_use_; // frames below may hold a page: pool_size_, more
+                         // while frames given up wait for ReleaseFrames
+                         // (protected by latch_)
+  FrameArena *descriptor_arena_; // cache line aligned frame descriptors
+  FrameArena *data_arena_;       // page aligned contents of the frames
+  Page *pages_;                  // array of pages, in descriptor_arena_
+  DiskManager *disk_manager_;
+  LogManager *log_manager_;
+  HashTable<page_id_t, Page *> *page_table_; // to keep track of pages,
+                                             // lock-free lookups
+  Replacer<Page *> *replacer_;   // to find an unpinned page for replacement
+  std::list<Page *> *free_list_; // to find a free page for replacement
+  std::mutex latch_;             // to protect shared data structure
+  std::condition_variable io_cv_; // signaled when a frame finishes its I/O
+  size_t async_reads_ = 0;        // prefetches in flight
+  BufferPoolCounters counters_; // statistics
+};
+} // namespace cmudb
@@ -4,15 +4,36 @@
  * Functionality: The simplified Buffer Manager interface allows a client to
  * new/delete pages on disk, to read a disk page into the buffer pool and pin
  * it, also to unpin a page in the buffer pool.
+ *
+ * The frames can be split into several independent BufferPoolInstances (each
+ * with its own latch, page table, replacer and free list); every page id is
+ * routed to one instance by hashing, so callers see a single pool.
+ *
+ * An optional background writer thread cleans dirty pages that are next in
+ * line for eviction, so that misses rarely have to write a victim back.
+ * Another thread services PrefetchPage hints, reading pages in before they
+ * are fetched (e.g. ahead of a sequential scan). Both queue their disk I/O
+ * asynchronously, so many pages are in flight at once.
+ *
+ * Fetching or creating pages with a BufferAccessStrategy confines the misses
+ * of the caller to a small ring of recycled frames.
+ *
+ * FlushAllPages writes the dirty pages back in page id order, coalescing
+ * consecutive pages, so shutdown and checkpoints do sequential I/O.
  */
 
 #pragma once
-#include <list>
-#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
+#include "buffer/buffer_pool_instance.h"
+#include "buffer/page_guard.h"
 #include "disk/disk_manager.h"
-#include "hash/extendible_hash.h"
 #include "logging/log_manager.h"
 #include "page/page.h"
 
@@ -20,28 +41,202 @@ namespace cmudb {
 class BufferPoolManager {
 public:
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
-                          LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr,
+                    size_t num_instances = 1,
+                    ReplacerType replacer_type = ReplacerType::LRU);
 
   ~BufferPoolManager();
 
-  Page *FetchPage(page_id_t page_id);
+  Page *FetchPage(page_id_t page_id,
+                  BufferAccessStrategy *strategy = nullptr);
+
+  Page *FetchResidentPage(page_id_t page_id);
+
+  // hint that page_id will be fetched soon; it is read in asynchronously.
+  // on_read, if given, is called with the page pinned once it is resident,
+  // e.g. to hint the page it links to. It may run on an I/O thread and
+  // must not block
+  void PrefetchPage(page_id_t page_id,
+                    std::shared_ptr<BufferAccessStrategy> strategy = nullptr,
+                    std::function<void(Page *)> on_read = nullptr);
+  // hint that count pages from first_page_id on will be read in order, so
+  // the kernel reads a memory-mapped file ahead of them
+  inline void AdviseSequential(page_id_t first_page_id, size_t count) {
+    disk_manager_->AdviseSequential(first_page_id, count);
+  }
 
   bool UnpinPage(page_id_t page_id, bool is_dirty);
 
   bool FlushPage(page_id_t page_id);
 
-  Page *NewPage(page_id_t &page_id);
+  // write back every dirty page sorted by page id, runs of consecutive pages
+  // coalesced into single writes and pinned one run at a time, then sync the
+  // file once (as the sync policy of the disk manager says). Return the
+  // number of pages written
+  size_t FlushDirtyPages();
+  // shutdown and checkpoints: every modification in the pool reaches disk
+  inline size_t FlushAllPages() { return FlushDirtyPages(); }
+
+  // owner (e.g. the first page of a table heap) keeps the pages of one
+  // object sequential on disk
+  Page *NewPage(page_id_t &page_id, BufferAccessStrategy *strategy = nullptr,
+                page_id_t owner = INVALID_PAGE_ID);
+
+  // fetch/create a page and latch it, pin and latch are released by the
+  // guard. The guard is not valid if all the pages are pinned
+  ReadPageGuard FetchPageRead(page_id_t page_id,
+                              BufferAccessStrategy *strategy = nullptr);
+  WritePageGuard FetchPageWrite(page_id_t page_id,
+                                BufferAccessStrategy *strategy = nullptr);
+  WritePageGuard NewPageGuarded(page_id_t &page_id,
+                                BufferAccessStrategy *strategy = nullptr,
+                                page_id_t owner = INVALID_PAGE_ID);
+
+  // a ring of ring_size frames for a scan or bulk load to recycle
+  std::shared_ptr<BufferAccessStrategy>
+  NewAccessStrategy(size_t ring_size = BUFFER_RING_SIZE) const {
+    return std::make_shared<BufferAccessStrategy>(instances_.size(),
+                                                  ring_size);
+  }
 
   bool DeletePage(page_id_t page_id);
 
+  // spawn a thread writing back pages_per_round dirty pages per instance
+  // every interval; an instance whose dirty ratio reaches dirty_ratio has all
+  // its evictable dirty pages written in that round
+  void RunBackgroundWriter(
+      size_t pages_per_round = BG_WRITER_PAGES,
+      std::chrono::milliseconds interval = BG_WRITER_INTERVAL,
+      double dirty_ratio = BG_WRITER_DIRTY_RATIO);
+  void StopBackgroundWriter();
+
+  // change the number of frames at runtime, spread over the instances like
+  // in the constructor and up to BUFFER_POOL_MAX_GROWTH times the initial
+  // size. Growing takes effect at once; frames given up by shrinking are
+  // evicted right away if unpinned, otherwise by a background thread once
+  // they are. Return false if pool_size is out of range, or if huge pages
+  // ran out while growing (GetPoolSize tells the size reached)
+  bool Resize(size_t pool_size);
+  // shrinking still waits for pinned frames
+  bool IsResizing();
+
+  // warm-up over a restart: the ids of the resident pages, hottest first,
+  // are written to a side file, periodically by the dumper and when it
+  // stops. WarmUp reads the hottest pages listed there in the background,
+  // in sorted runs of consecutive pages, into frames that are still free.
+  // Return false if the file cannot be written / read
+  bool DumpResidentPages(const std::string &file_name);
+  bool WarmUp(const std::string &file_name);
+  bool IsWarmingUp();
+  void RunResidentPageDumper(
+      const std::string &file_name,
+      std::chrono::milliseconds interval = WARMUP_DUMP_INTERVAL);
+  // dumps one last time
+  void StopResidentPageDumper();
+
+  inline size_t GetPageSize() const { return disk_manager_->GetPageSize(); }
+  // what page formats may use of a page, see Page::GetDataSize
+  inline size_t GetPageDataSize() const {
+    return GetPageSize() - PAGE_CHECKSUM_SIZE;
+  }
+  inline size_t GetPoolSize() const { return pool_size_; }
+
+  // per instance statistics, used to tune the number of instances
+  inline size_t GetNumInstances() const { return instances_.size(); }
+  inline size_t GetPoolSize(size_t instance_index) const {
+    return instances_[instance_index]->GetPoolSize();
+  }
+  inline BufferPoolStats GetStats(size_t instance_index) const {
+    return instances_[instance_index]->GetStats();
+  }
+  // statistics of all the instances together
+  inline BufferPoolStats GetStats() const {
+    BufferPoolStats stats;
+    for (auto instance : instances_)
+      stats.Merge(instance->GetStats());
+    return stats;
+  }
+  inline size_t GetHitCount(size_t instance_index) const {
+    return instances_[instance_index]->GetHitCount();
+  }
+  inline size_t GetMissCount(size_t instance_index) const {
+    return instances_[instance_index]->GetMissCount();
+  }
+  inline size_t GetWriteBackCount(size_t instance_index) const {
+    return instances_[instance_index]->GetWriteBackCount();
+  }
+  inline size_t GetPrefetchCount(size_t instance_index) const {
+    return instances_[instance_index]->GetPrefetchCount();
+  }
+  // write-backs that had to wait for the log to be flushed first
+  inline size_t GetLogForceCount(size_t instance_index) const {
+    return instances_[instance_index]->GetLogForceCount();
+  }
+  inline double GetDirtyRatio(size_t instance_index) const {
+    return instances_[instance_index]->GetDirtyRatio();
+  }
+  // e.g. to read the adaptation state of ARCReplacer
+  inline Replacer<Page *> *GetReplacer(size_t instance_index) const {
+    return instances_[instance_index]->GetReplacer();
+  }
+  // used by page guards that had to wait for the latch of a page
+  inline void
+  RecordPageLatchWait(page_id_t page_id,
+                      std::chrono::steady_clock::duration latency) {
+    GetInstance(page_id)->RecordPageLatchWait(latency);
+  }
+
 private:
-  size_t pool_size_; // number of pages in buffer pool
-  Page *pages_;      // array of pages
+  // instance that is responsible for page_id
+  inline size_t GetInstanceIndex(page_id_t page_id) const {
+    return std::hash<page_id_t>()(page_id) % instances_.size();
+  }
+  inline BufferPoolInstance *GetInstance(page_id_t page_id) {
+    return instances_[GetInstanceIndex(page_id)];
+  }
+  // part of the ring of strategy in the instance of page_id
+  inline BufferRing *GetRing(page_id_t page_id,
+                             BufferAccessStrategy *strategy) {
+    if (strategy == nullptr)
+      return nullptr;
+    return &strategy->rings_[GetInstanceIndex(page_id)];
+  }
+
+  std::atomic<size_t> pool_size_; // number of pages in buffer pool
   DiskManager *disk_manager_;
   LogManager *log_manager_;
-  HashTable<page_id_t, Page *> *page_table_; // to keep track of pages
-  Replacer<Page *> *replacer_;   // to find an unpinned page for replacement
-  std::list<Page *> *free_list_; // to find a free page for replacement
-  std::mutex latch_;             // to protect shared data structure
+  std::vector<BufferPoolInstance *> instances_; // partitions of the pool
+  // background writer
+  std::thread *writer_thread_ = nullptr;
+  bool writer_running_ = false;
+  std::mutex writer_latch_;
+  std::condition_variable writer_cv_; // to stop the writer while it sleeps
+  // prefetch thread, started by the first hint
+  std::thread *prefetch_thread_ = nullptr;
+  bool prefetch_running_ = false;
+  // hints not serviced yet
+  struct PrefetchHint {
+    page_id_t page_id_;
+    std::shared_ptr<BufferAccessStrategy> strategy_;
+    std::function<void(Page *)> on_read_;
+  };
+  std::deque<PrefetchHint> prefetch_queue_;
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  // warm-up thread, gone when it is done
+  std::thread *warmup_thread_ = nullptr;
+  std::atomic<bool> warmup_running_{false};
+  // periodic dump of the resident pages
+  std::thread *dumper_thread_ = nullptr;
+  bool dumper_running_ = false;
+  std::string dumper_file_name_;
+  std::mutex dumper_latch_;
+  std::condition_variable dumper_cv_;
+  // releases frames of a shrink that were pinned, while there are any
+  std::thread *resize_thread_ = nullptr;
+  bool resize_running_ = false;
+  bool resize_pending_ = false; // frames left to release
+  std::mutex resize_latch_;
+  std::condition_variable resize_cv_;
 };
 } // namespace cmudb
@@ -0,0 +1,108 @@
+/**
+ * buffer_pool_stats.h
+ *
+ * Instrumentation of a buffer pool instance. Event counters are sharded by
+ * thread so that concurrent hits do not contend on one cache line, latencies
+ * go into histograms with power of two buckets of nanoseconds. Recording
+ * only does relaxed atomic adds; GetStats takes a BufferPoolStats snapshot,
+ * which can be merged across instances.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+#define STATS_SHARDS 8        // counter shards per buffer pool instance
+#define HISTOGRAM_BUCKETS 32  // bucket i holds values below 2^i ns
+
+enum class BufferPoolEvent {
+  HIT = 0,        // page found in the pool
+  MISS,           // page read from disk
+  EVICTION,       // resident page replaced by another one
+  DIRTY_EVICTION, // evicted page written back first
+  WRITE_BACK,     // page cleaned by the background writer
+  FLUSH,          // page written by FlushPage
+  PREFETCH,       // page read by PrefetchPage, not counted as a miss
+  WARM_UP,        // page read by WarmUp, not counted as a miss
+  LOG_FORCE,      // log flushed to write a page back (WAL)
+  NUM_EVENTS
+};
+
+struct HistogramSnapshot {
+  uint64_t count_ = 0;
+  uint64_t sum_ = 0; // in nanoseconds
+  uint64_t buckets_[HISTOGRAM_BUCKETS] = {};
+
+  void Merge(const HistogramSnapshot &that);
+  double GetMean() const;
+  // upper bound of the bucket holding the given fraction (0-1) of values
+  uint64_t GetPercentile(double fraction) const;
+};
+
+struct BufferPoolStats {
+  uint64_t events_[static_cast<size_t>(BufferPoolEvent::NUM_EVENTS)] = {};
+  HistogramSnapshot read_latency_;    // disk reads
+  HistogramSnapshot write_latency_;   // disk writes
+  HistogramSnapshot latch_wait_;      // contended acquisitions of latch_
+  HistogramSnapshot page_latch_wait_; // contended page latches in guards
+
+  inline uint64_t Get(BufferPoolEvent event) const {
+    return events_[static_cast<size_t>(event)];
+  }
+  void Merge(const BufferPoolStats &that);
+  double GetHitRatio() const;
+};
+
+class LatencyHistogram {
+public:
+  void Record(std::chrono::steady_clock::duration latency);
+  HistogramSnapshot Snapshot() const;
+
+private:
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> buckets_[HISTOGRAM_BUCKETS] = {};
+};
+
+class BufferPoolCounters {
+public:
+  inline void Add(BufferPoolEvent event, uint64_t n = 1) {
+    shards_[GetShardIndex()].events_[static_cast<size_t>(event)].fetch_add(
+        n, std::memory_order_relaxed);
+  }
+  inline uint64_t Get(BufferPoolEvent event) const {
+    uint64_t sum = 0;
+    for (auto &shard : shards_)
+      sum += shard.events_[static_cast<size_t>(event)].load(
+          std::memory_order_relaxed);
+    return sum;
+  }
+  BufferPoolStats Snapshot() const;
+
+  LatencyHistogram read_latency_;
+  LatencyHistogram write_latency_;
+  LatencyHistogram latch_wait_;
+  LatencyHistogram page_latch_wait_;
+
+private:
+  // padded rather than aligned (instances are allocated by plain new), so
+  // that no two shards share a cache line wherever the array starts
+  struct Shard {
+    std::atomic<uint64_t>
+        events_[static_cast<size_t>(BufferPoolEvent::NUM_EVENTS)] = {};
+    char padding_[2 * CACHE_LINE_SIZE -
+                  sizeof(std::atomic<uint64_t>) *
+                      static_cast<size_t>(BufferPoolEvent::NUM_EVENTS)];
+  };
+  static size_t GetShardIndex();
+
+  Shard shards_[STATS_SHARDS];
+};
+
+} // namespace cmudb
@@ -0,0 +1,62 @@
+/**
+ * clock_replacer.h
+ *
+ * Functionality: CLOCK approximation of LRU. Every frame owns one slot of a
+ * fixed array that says whether the frame can be evicted and whether it was
+ * referenced since the clock hand last passed it. Insert/Erase only flip the
+ * slot of the frame, so nothing is allocated or locked on unpin; only Victim
+ * serializes on the clock hand. The hand sweeps the frames in use, whose
+ * number follows the buffer pool through SetCapacity.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class ClockReplacer : public Replacer<T> {
+public:
+  // values are mapped to frame ids by their distance from base, e.g. the
+  // first page of the frame array, or 0 for integral values
+  ClockReplacer(size_t num_frames, const T &base = T());
+
+  ~ClockReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Victim(T &value, const std::function<bool(const T &)> &can_evict);
+
+  bool Erase(const T &value);
+
+  size_t Size();
+
+  void GetVictimCandidates(std::vector<T> &candidates, size_t max_values);
+
+  // must not run concurrently with Insert/Erase (the buffer pool calls them
+  // all under its latch). Slots are only ever added, so frames above a
+  // smaller capacity can still be erased
+  void SetCapacity(size_t capacity);
+
+private:
+  enum FrameState : char { NOT_EVICTABLE = 0, EVICTABLE, REFERENCED };
+
+  inline size_t FrameId(const T &value) const {
+    return static_cast<size_t>(value - base_);
+  }
+
+  size_t num_frames_; // swept by the clock hand
+  size_t num_slots_;  // allocated, at least num_frames_
+  T base_;
+  std::atomic<char> *state_; // one slot per frame
+  std::atomic<size_t> size_; // number of evictable frames
+  size_t hand_;              // current position of the clock hand
+  std::mutex hand_latch_;    // to protect hand_
+};
+
+} // namespace cmudb
@@ -0,0 +1,52 @@
+/**
+ * frame_arena.h
+ *
+ * Page aligned memory for the buffer pool, mapped anonymously so page
+ * contents of all the frames are contiguous and can be backed by huge pages
+ * to save TLB entries on large pools. With huge_pages set, MAP_HUGETLB is
+ * tried first and the arena falls back to normal pages advised as
+ * transparent huge pages when none are reserved.
+ * Normal pages are only committed when touched, so an arena can reserve
+ * room for a pool to grow into. Huge pages would fault when touched without
+ * being reserved, so a huge page arena is address space only until Commit
+ * maps huge pages over a range; Release hands memory back to the system.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cmudb {
+
+class FrameArena {
+public:
+  // size is rounded up to whole (huge) pages, the memory is zeroed. Of a
+  // huge page arena only the first committed bytes are mapped
+  FrameArena(size_t size, bool huge_pages = false,
+             size_t committed = SIZE_MAX);
+  ~FrameArena();
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  // map the huge pages of [offset, offset + size) before they are touched,
+  // false if the huge page pool has run out
+  bool Commit(size_t offset, size_t size);
+  // give back the memory of whole pages in [offset, offset + size), they
+  // read as zero when touched again (huge pages once committed again)
+  void Release(size_t offset, size_t size);
+
+  inline char *GetData() const { return data_; }
+  inline size_t GetSize() const { return size_; }
+  // whether the arena got pages from the huge page pool
+  inline bool IsHugeTLB() const { return huge_tlb_; }
+
+private:
+  char *data_;
+  size_t size_;
+  bool huge_tlb_;
+  std::vector<bool> committed_; // huge pages mapped, by index
+};
+
+} // namespace cmudb
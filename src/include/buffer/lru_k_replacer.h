@@ -0,0 +1,79 @@
+/**
+ * lru_k_replacer.h
+ *
+ * Functionality: LRU-K replacement. The replacer remembers the last K access
+ * timestamps of every value and evicts the value whose K-th most recent access
+ * is the oldest (largest backward K-distance). Values with fewer than K
+ * accesses have infinite distance and go first, oldest first access first, so
+ * pages touched once by a sequential scan are evicted before pages that are
+ * used repeatedly.
+ *
+ * Accesses of a value within a correlated reference period of each other
+ * (counted in accesses to the replacer) are one access, as in the LRU-K
+ * paper: a scan that pins its page once per tuple does not make the page
+ * look as hot as one used again and again.
+ */
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <utility>
+
+#include "buffer/replacer.h"
+
+namespace cmudb {
+
+template <typename T> class LRUKReplacer : public Replacer<T> {
+public:
+  // correlation_period: an access at most that many accesses after the
+  // previous one of the same value only moves it, 0 counts them all
+  explicit LRUKReplacer(size_t k = 2, size_t correlation_period = 0);
+
+  ~LRUKReplacer();
+
+  void Insert(const T &value);
+
+  bool Victim(T &value);
+
+  bool Victim(T &value, const std::function<bool(const T &)> &can_evict);
+
+  bool Erase(const T &value);
+
+  bool Evict(const T &value);
+
+  size_t Size();
+
+  void RecordAccess(const T &value);
+
+  void Remove(const T &value);
+
+  void GetVictimCandidates(std::vector<T> &candidates, size_t max_values);
+
+private:
+  struct History {
+    std::deque<size_t> timestamps; // at most k_, oldest first; the last
+                                   // one is the latest access
+    bool evictable = false;
+  };
+  typedef std::pair<size_t, T> Candidate; // <ordering timestamp, value>
+
+  // candidate key of value: the oldest of its remembered timestamps
+  inline Candidate GetCandidate(const T &value, const History &history) {
+    return std::make_pair(history.timestamps.front(), value);
+  }
+  // take an evictable value out of the candidate sets
+  void RemoveCandidate(const T &value, History &history);
+
+  size_t k_;
+  size_t correlation_period_;
+  size_t current_timestamp_;
+  std::map<T, History> history_;
+  std::set<Candidate> infinite_; // evictable, fewer than k_ accesses
+  std::set<Candidate> finite_;   // evictable, k_ accesses
+  std::mutex mtx;
+};
+
+} // namespace cmudb
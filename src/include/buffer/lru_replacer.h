@@ -36,10 +36,14 @@ class LRUReplacer : public Replacer<T>
 
     bool Victim(T &value);
 
+    bool Victim(T &value, const std::function<bool(const T &)> &can_evict);
+
     bool Erase(const T &value);
 
     size_t Size();
 
+    void GetVictimCandidates(std::vector<T> &candidates, size_t max_values);
+
   private:
     // add your member variables here
     std::map<T, LRUlist<T>* > metadata;
@@ -0,0 +1,85 @@
+/*
+ * page_guard.h
+ *
+ * Functionality: Move-only handles on a page fetched from the buffer pool.
+ * A ReadPageGuard holds the pin and the read latch of a page, a
+ * WritePageGuard the pin and the write latch; both are released when the
+ * guard is destroyed, dropped or assigned another page, so pins cannot leak
+ * on early returns or exceptions. A WritePageGuard remembers whether the page
+ * was modified (AsMut or MarkDirty) and unpins it dirty accordingly.
+ * A guard whose fetch failed (all the pages pinned) is not valid.
+ */
+
+#pragma once
+
+#include "page/page.h"
+
+namespace cmudb {
+class BufferPoolManager;
+
+class ReadPageGuard {
+public:
+  ReadPageGuard() = default;
+  // page must be pinned already, the guard takes over the pin
+  ReadPageGuard(BufferPoolManager *buffer_pool_manager, Page *page);
+  ReadPageGuard(ReadPageGuard &&that) noexcept;
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+  ~ReadPageGuard() { Drop(); }
+
+  // unlatch and unpin the page now
+  void Drop();
+
+  inline bool IsValid() const { return page_ != nullptr; }
+  inline Page *GetPage() const { return page_; }
+  inline page_id_t GetPageId() const { return page_->GetPageId(); }
+  inline const char *GetData() const { return page_->GetData(); }
+  template <typename T> inline const T *As() const {
+    return reinterpret_cast<const T *>(page_);
+  }
+
+private:
+  BufferPoolManager *buffer_pool_manager_ = nullptr;
+  Page *page_ = nullptr;
+};
+
+class WritePageGuard {
+public:
+  WritePageGuard() = default;
+  // page must be pinned already, the guard takes over the pin
+  WritePageGuard(BufferPoolManager *buffer_pool_manager, Page *page,
+                 bool is_dirty = false);
+  WritePageGuard(WritePageGuard &&that) noexcept;
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+  WritePageGuard(const WritePageGuard &) = delete;
+  WritePageGuard &operator=(const WritePageGuard &) = delete;
+  ~WritePageGuard() { Drop(); }
+
+  // unlatch and unpin the page now
+  void Drop();
+
+  inline bool IsValid() const { return page_ != nullptr; }
+  inline Page *GetPage() const { return page_; }
+  inline page_id_t GetPageId() const { return page_->GetPageId(); }
+  inline const char *GetData() const { return page_->GetData(); }
+  inline char *GetDataMut() {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+  // to look at the page, AsMut to modify it
+  template <typename T> inline const T *As() const {
+    return reinterpret_cast<const T *>(page_);
+  }
+  template <typename T> inline T *AsMut() {
+    is_dirty_ = true;
+    return reinterpret_cast<T *>(page_);
+  }
+  inline void MarkDirty() { is_dirty_ = true; }
+
+private:
+  BufferPoolManager *buffer_pool_manager_ = nullptr;
+  Page *page_ = nullptr;
+  bool is_dirty_ = false;
+};
+} // namespace cmudb
@@ -6,17 +6,44 @@
 #pragma once
 
 #include <cstdlib>
+#include <functional>
+#include <vector>
 
 namespace cmudb {
 
+// replacement policies the buffer pool can be built with
+enum class ReplacerType { LRU = 0, CLOCK, LRU_K, ARC };
+
 template <typename T> class Replacer {
 public:
   Replacer() {}
   virtual ~Replacer() {}
   virtual void Insert(const T &value) = 0;
   virtual bool Victim(T &value) = 0;
+  // Victim, passing over the values can_evict rejects: they stay evictable
+  // with their place and history untouched. can_evict is called under the
+  // replacer's lock and may claim the value it accepts for the caller
+  virtual bool Victim(T &value,
+                      const std::function<bool(const T &)> &can_evict) = 0;
   virtual bool Erase(const T &value) = 0;
+  // evict value, chosen by the caller among the candidates, as if Victim had
+  // returned it. Return false if value is not evictable. Policies that keep
+  // history of evicted values override this, the default only erases value
+  virtual bool Evict(const T &value) { return Erase(value); }
   virtual size_t Size() = 0;
+  // value was accessed (pinned) by the buffer pool. Policies that keep access
+  // history override this, the default ignores it
+  virtual void RecordAccess(const T &value) {}
+  // value no longer holds its page (page deleted, frame freed). Policies that
+  // keep history per value drop it here, the default only erases value
+  virtual void Remove(const T &value) { Erase(value); }
+  // append up to max_values evictable values, roughly in the order Victim
+  // would return them, without evicting anything. The default knows no order
+  virtual void GetVictimCandidates(std::vector<T> &candidates,
+                                   size_t max_values) {}
+  // the buffer pool was resized to capacity frames. Policies sized by the
+  // number of frames override this, the default ignores it
+  virtual void SetCapacity(size_t capacity) {}
 };
 
 } // namespace cmudb
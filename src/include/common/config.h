@@ -16,15 +16,47 @@ extern std::chrono::duration<long long int> LOG_TIMEOUT;
 
 extern std::atomic<bool> ENABLE_LOGGING;
 
+extern std::chrono::milliseconds BG_WRITER_INTERVAL;
+
+extern std::chrono::milliseconds WARMUP_DUMP_INTERVAL;
+
+// back buffer pool frames with huge pages
+extern bool BUFFER_POOL_HUGE_PAGES;
+
 #define INVALID_PAGE_ID -1 // representing an invalid page id
 #define INVALID_TXN_ID -1  // representing an invalid txn id
 #define INVALID_LSN -1     // representing an invalid lsn
 #define HEADER_PAGE_ID 0   // the header page id
-#define PAGE_SIZE 512     // size of a data page in byte
-#define LOG_BUFFER_SIZE                                                            \
-  ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE) // size of a log buffer in byte
+#define PAGE_SIZE 512     // default size of a data page in byte
+#define MIN_PAGE_SIZE 512   // page sizes are powers of two in this range
+#define MAX_PAGE_SIZE 65536
+#define CACHE_LINE_SIZE 64              // frame descriptors are aligned to it
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024) // size of a huge page in byte
+// size of a log buffer in byte, one page more than the buffer pool holds
+#define LOG_BUFFER_SIZE(page_size, pool_size) (((pool_size) + 1) * (page_size))
 #define BUCKET_SIZE 50                 // size of extendible hash bucket
-#define BUFFER_POOL_SIZE 10            // size of buffer pool
+#define BUFFER_POOL_SIZE 10            // default size of buffer pool
+#define BUFFER_POOL_INSTANCES 1        // number of buffer pool partitions
+#define BUFFER_POOL_MAX_GROWTH 4 // online resize up to this times initial size
+#define WARMUP_READ_PAGES 32 // longest run of pages read at once by warm-up
+#define FLUSH_WRITE_PAGES 64 // longest run of pages written at once by a flush
+#define WAL_VICTIM_CANDIDATES 8 // victims looked at for one not forcing the log
+#define ASYNC_IO_QUEUE_DEPTH 64 // asynchronous I/Os in flight per disk manager
+#define ASYNC_IO_THREADS 4      // I/O threads where there is no io_uring
+#define DIRECT_IO_ALIGNMENT 4096 // of buffers, offsets and sizes with O_DIRECT
+#define PUNCH_HOLE_PAGES 16 // free pages in a row given back to the file system
+#define EXTENT_PAGES 64     // pages reserved at a time for one table or index
+#define PAGE_CHECKSUM_SIZE 4 // crc32c at the end of every page on disk
+#define LRUK_REPLACER_K 2              // history length of LRU-K replacer
+// LRU-K and ARC count a page accessed again within this many accesses of the
+// replacer as accessed once, like a scan pinning it for every tuple
+#define CORRELATED_REFERENCE_PERIOD 8
+#define BG_WRITER_PAGES 4   // pages cleaned per instance per writer round
+#define BG_WRITER_DIRTY_RATIO 0.5 // dirty ratio making the writer hurry
+#define TABLE_READ_AHEAD_PAGES 4  // pages read ahead by table heap scans
+// frames of a scan's buffer ring: the pages read ahead of the scan, the
+// page it is on and the one it leaves, pinned until the next one is latched
+#define BUFFER_RING_SIZE (TABLE_READ_AHEAD_PAGES + 2)
 
 typedef int32_t page_id_t; // page id type
 typedef int32_t txn_id_t;  // transaction id type
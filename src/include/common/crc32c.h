@@ -0,0 +1,29 @@
+/**
+ * crc32c.h
+ *
+ * CRC32C (Castagnoli polynomial), the checksum of pages on disk. It is
+ * computed with the SSE4.2 crc32 instruction when the build targets a CPU
+ * having it (-march=native), otherwise with tables (slicing by 8).
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit crc32 instruction available
+#if defined(__SSE4_2__) && defined(__x86_64__)
+#define CRC32C_SSE42
+#endif
+
+namespace cmudb {
+
+uint32_t Crc32c(const char *data, size_t size);
+
+// the implementations, for tests and benchmarks; Crc32c is one of them
+uint32_t Crc32cTable(const char *data, size_t size);
+#ifdef CRC32C_SSE42
+uint32_t Crc32cHardware(const char *data, size_t size);
+#endif
+
+} // namespace cmudb
@@ -40,6 +40,14 @@ public:
     reader_.notify_all();
   }
 
+  bool TryWLock() {
+    std::lock_guard<mutex_t> guard(mutex_);
+    if (writer_entered_ || reader_count_ > 0)
+      return false;
+    writer_entered_ = true;
+    return true;
+  }
+
   void RLock() {
     std::unique_lock<mutex_t> lock(mutex_);
     while (writer_entered_ || reader_count_ == max_readers_)
@@ -47,6 +55,14 @@ public:
     reader_count_++;
   }
 
+  bool TryRLock() {
+    std::lock_guard<mutex_t> guard(mutex_);
+    if (writer_entered_ || reader_count_ == max_readers_)
+      return false;
+    reader_count_++;
+    return true;
+  }
+
   void RUnlock() {
     std::lock_guard<mutex_t> guard(mutex_);
     reader_count_--;
@@ -0,0 +1,126 @@
+/**
+ * async_io.h
+ *
+ * Asynchronous positional reads and writes, so that one thread can keep many
+ * I/Os in flight. On Linux they go through an io_uring; where the kernel does
+ * not provide one (or forbids it), a small pool of threads does pread/pwrite
+ * instead. Completion callbacks run on an I/O thread.
+ */
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <sys/types.h>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+
+namespace cmudb {
+
+// outcome of an I/O: number of bytes transferred (less than asked only at
+// the end of the file), or -errno
+typedef std::function<void(ssize_t)> IOCallback;
+
+class AsyncIO {
+public:
+  virtual ~AsyncIO() {}
+
+  // queue a transfer of size bytes at offset of fd; the buffer must stay
+  // valid until callback has run. Callbacks must not queue I/O themselves.
+  // Block while queue_depth I/Os are in flight
+  virtual void Read(int fd, char *data, size_t size, size_t offset,
+                    IOCallback callback) = 0;
+  virtual void Write(int fd, const char *data, size_t size, size_t offset,
+                     IOCallback callback) = 0;
+
+  virtual bool IsIOUring() const = 0;
+
+  // an io_uring if use_io_uring and the kernel allows it, otherwise a pool
+  // of threads. The destructor waits for the I/Os in flight
+  static AsyncIO *Create(size_t queue_depth = ASYNC_IO_QUEUE_DEPTH,
+                         bool use_io_uring = true);
+};
+
+// fallback: threads running pread/pwrite
+class ThreadPoolIO : public AsyncIO {
+public:
+  ThreadPoolIO(size_t queue_depth, size_t num_threads = ASYNC_IO_THREADS);
+  ~ThreadPoolIO();
+
+  void Read(int fd, char *data, size_t size, size_t offset,
+            IOCallback callback) override;
+  void Write(int fd, const char *data, size_t size, size_t offset,
+             IOCallback callback) override;
+  bool IsIOUring() const override { return false; }
+
+private:
+  struct Request {
+    bool is_write_;
+    int fd_;
+    char *data_;
+    size_t size_;
+    size_t offset_;
+    IOCallback callback_;
+  };
+  void Submit(Request &&request);
+  void Work();
+
+  size_t queue_depth_;
+  size_t in_flight_ = 0; // queued or being done
+  bool running_ = true;
+  std::deque<Request> queue_;
+  std::mutex latch_;
+  std::condition_variable cv_;      // wakes up workers
+  std::condition_variable done_cv_; // wakes up submitters and destructor
+  std::vector<std::thread> threads_;
+};
+
+// io_uring driven by raw system calls, with one thread reaping completions
+class IOUring : public AsyncIO {
+public:
+  // throws std::system_error if the ring cannot be set up
+  explicit IOUring(size_t queue_depth);
+  ~IOUring();
+
+  void Read(int fd, char *data, size_t size, size_t offset,
+            IOCallback callback) override;
+  void Write(int fd, const char *data, size_t size, size_t offset,
+             IOCallback callback) override;
+  bool IsIOUring() const override { return true; }
+
+private:
+  struct Request;
+  // put request on the submission queue and enter it, caller holds latch_
+  void Push(Request *request, std::unique_lock<std::mutex> &lock);
+  // run the callbacks of the completions posted so far
+  void ReapCompletions();
+  void Submit(Request *request);
+  void Reap();
+
+  int ring_fd_;
+  // signaled by the kernel on every completion, and by the destructor to
+  // stop the reaper, which sleeps on it
+  int event_fd_;
+  unsigned entries_;
+  // submission queue ring, its entries and the completion queue ring
+  void *sq_ring_;
+  size_t sq_ring_size_;
+  void *sqes_;
+  size_t sqes_size_;
+  void *cq_ring_;
+  size_t cq_ring_size_;
+  unsigned *sq_head_, *sq_tail_, *sq_mask_, *sq_array_;
+  unsigned *cq_head_, *cq_tail_, *cq_mask_;
+  void *cqes_;
+
+  size_t in_flight_ = 0;
+  bool running_ = true;
+  std::mutex latch_; // serializes submissions
+  std::condition_variable done_cv_;
+  std::thread *reaper_;
+};
+
+} // namespace cmudb
@@ -5,46 +5,233 @@
  * database. It also performs read and write of pages to and from disk, and
  * provides a logical file layer within the context of a database management
  * system.
+ *
+ * The first page of the database file is a header holding the page size and
+ * buffer pool size the database was created with, so they need not be
+ * compiled in; page 0 follows it.
+ *
+ * Which pages are allocated is tracked in bitmap pages stored in the file:
+ * one precedes every page_size * 8 pages, so the file reads
+ * header | bitmap 0 | pages 0.. | bitmap 1 | pages .. Freed pages are reused
+ * and long runs of them are punched out of the file (the file keeps its
+ * size but no longer its blocks). Pages allocated for an owner (a table heap,
+ * an index) are carved from extents of EXTENT_PAGES contiguous pages
+ * reserved for it and preallocated, so that objects growing at the same
+ * time do not interleave their pages. On reopen the bitmaps tell where
+ * allocation resumes. Files of version 1 have no bitmap: pages are neither
+ * reused nor grouped in extents, and allocation resumes at the end of the file.
+ *
+ * Every page ends with a CRC32C checksum of the rest, stored when it is
+ * written and verified when it is read, to catch silent corruption. Files
+ * older than version 3 have no checksums.
+ *
+ * Read-only mode, for replicas serving reports, maps the data file, so that
+ * reads are copies from the page cache without a system call.
+ *
+ * Page writes are not synced one by one by default: SyncPages, called by
+ * checkpoints, makes all the writes since the last sync durable at once
+ * (see SyncPolicy).
+ *
+ * Both files are accessed with positional I/O (pread/pwrite) on raw file
+ * descriptors and their sizes are cached, so threads read and write
+ * different pages in parallel. Page reads and writes can also be queued
+ * asynchronously (through io_uring where available, see AsyncIO), to keep
+ * many of them in flight from one thread.
+ *
+ * In direct I/O mode the data file is opened with O_DIRECT, bypassing the
+ * OS page cache so the buffer pool is the only cache of pages. This needs
+ * pages that are a multiple of DIRECT_IO_ALIGNMENT; frames of the buffer
+ * pool are aligned, other buffers are copied through an aligned one.
  */
 
 #pragma once
+#include <algorithm>
 #include <atomic>
-#include <fstream>
+#include <functional>
 #include <future>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
+#include "disk/async_io.h"
 
 namespace cmudb {
 
+// when page writes to the db file are made durable. With the log in place
+// pages only need to be on disk by checkpoint time
+enum class SyncPolicy {
+  PER_WRITE,  // every page write is synced before it completes
+  CHECKPOINT, // SyncPages (called by checkpoints) syncs all the writes
+  OS          // never synced, the OS writes pages back when it likes
+};
+
 class DiskManager {
 public:
-  DiskManager(const std::string &db_file);
+  // page_size and pool_size are stored in the header of a new file; 0 means
+  // the value stored in an existing file, or the compile time default. The
+  // page size of an existing file cannot be changed. direct_io is ignored
+  // (with a debug message) if the page size or file system do not allow it.
+  // A read_only file is memory-mapped; writes to it fail and no page can be
+  // allocated
+  DiskManager(const std::string &db_file, size_t page_size = 0,
+              size_t pool_size = 0, bool direct_io = false,
+              bool read_only = false);
   ~DiskManager();
 
-  void WritePage(page_id_t page_id, const char *page_data);
-  void ReadPage(page_id_t page_id, char *page_data);
+  // the writes store the checksum of a page in its last PAGE_CHECKSUM_SIZE
+  // bytes on disk, which page formats leave alone; page_data is not changed.
+  // false on I/O error
+  bool WritePage(page_id_t page_id, const char *page_data);
+  // false on I/O error or if the page fails its checksum; a page past the
+  // end of the file reads as zeroes
+  bool ReadPage(page_id_t page_id, char *page_data);
+  // read count consecutive pages with a single read, return how many of
+  // them exist in the file (the rest is zeroed). If valid is given, one
+  // entry per page read is appended to it, false if the page failed its
+  // checksum
+  size_t ReadPages(page_id_t first_page_id, size_t count, char *page_data,
+                   std::vector<bool> *valid = nullptr);
+  // write consecutive pages, starting at first_page_id, from separate
+  // buffers with a single vectored write. Nothing is synced. False on I/O
+  // error, some of the pages may have been written anyway
+  bool WritePages(page_id_t first_page_id,
+                  const std::vector<const char *> &page_data);
+  // make the pages written so far durable, according to the sync policy
+  void SyncPages();
+  inline void SetSyncPolicy(SyncPolicy policy) { sync_policy_ = policy; }
+  inline SyncPolicy GetSyncPolicy() const { return sync_policy_; }
+  // fdatasync calls on the db file so far
+  inline size_t GetNumSyncs() const { return num_syncs_; }
+
+  // asynchronous page I/O, so that a thread keeps many I/Os in flight: done
+  // is called on an I/O thread with false on error, and must not start
+  // other asynchronous I/O. A read past the end of the file is zero-filled
+  void ReadPageAsync(page_id_t page_id, char *page_data,
+                     std::function<void(bool)> done);
+  void WritePageAsync(page_id_t page_id, const char *page_data,
+                      std::function<void(bool)> done);
+  // whether the asynchronous I/O goes through io_uring
+  bool IsIOUring();
 
   void WriteLog(char *log_data, int size);
   bool ReadLog(char *log_data, int size, int offset);
 
-  page_id_t AllocatePage();
+  // pages of the same owner are kept sequential in the file
+  page_id_t AllocatePage(page_id_t owner = INVALID_PAGE_ID);
   void DeallocatePage(page_id_t page_id);
 
+  inline size_t GetPageSize() const { return page_size_; }
+  inline size_t GetPoolSize() const { return pool_size_; }
+  inline bool IsDirectIO() const { return direct_io_; }
+  inline bool IsReadOnly() const { return read_only_; }
+  inline bool IsMapped() const { return map_ != nullptr; }
+  // read-only mode: pages about to be scanned in order are read ahead
+  void AdviseSequential(page_id_t first_page_id, size_t count);
+  // pages of the mapping advised to be read ahead so far
+  inline size_t GetNumAdvisedPages() const { return num_advised_pages_; }
+  // whether pages carry a checksum, and whether reads verify it
+  inline bool HasChecksums() const { return checksums_; }
+  inline void SetVerifyChecksums(bool verify) { verify_checksums_ = verify; }
+  // pages read that failed their checksum
+  inline size_t GetChecksumFailures() const { return checksum_failures_; }
+
   int GetNumFlushes() const;
   bool GetFlushState() const;
   inline void SetFlushLogFuture(std::future<void> *f) { flush_log_f_ = f; }
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
 private:
-  int GetFileSize(const std::string &name);
-  // stream to write log file
-  std::fstream log_io_;
+  size_t GetFileSize(int fd);
+  void GrowFileSize(std::atomic<size_t> &file_size, size_t end);
+  // positional I/O, retried until done
+  size_t ReadAt(int fd, char *data, size_t size, size_t offset);
+  bool WriteAt(int fd, const char *data, size_t size, size_t offset);
+  // created by the first asynchronous I/O
+  AsyncIO *GetAsyncIO();
+  bool ReadFileHeader();
+  void WriteFileHeader();
+  // switch the data file to O_DIRECT, return false if it cannot be
+  bool EnableDirectIO();
+  void MapFile();
+  // whether O_DIRECT I/O can use data as it is
+  inline bool IsAligned(const char *data) const {
+    return !direct_io_ ||
+           reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT == 0;
+  }
+  // page I/O on the data file, through an aligned copy if data is not
+  size_t ReadPageData(char *data, size_t size, size_t offset);
+  bool WritePageData(const char *data, size_t size, size_t offset);
+  // file offset of a page, past the file header and the bitmap pages
+  inline size_t GetPageOffset(page_id_t page_id) const {
+    if (pages_per_bitmap_ == 0)
+      return header_size_ + size_t(page_id) * page_size_;
+    return header_size_ +
+           (page_id + page_id / pages_per_bitmap_ + 1) * page_size_;
+  }
+  inline size_t GetBitmapOffset(size_t index) const {
+    return header_size_ + index * (pages_per_bitmap_ + 1) * page_size_;
+  }
+  // how many of count pages from page_id are contiguous in the file
+  inline size_t GetSegmentLength(page_id_t page_id, size_t count) const {
+    if (pages_per_bitmap_ == 0)
+      return count;
+    return std::min(count, pages_per_bitmap_ - page_id % pages_per_bitmap_);
+  }
+  // allocation bitmap
+  void ReadBitmaps();
+  char *NewBitmap();
+  void SetAllocated(page_id_t page_id, bool allocated);
+  bool IsAllocated(page_id_t page_id) const;
+  void PunchFreeRun(page_id_t page_id);
+  page_id_t SkipAllocated(page_id_t page_id) const;
+  void PagesWritten();
+  void SyncFile();
+  // page checksums
+  char *AllocatePages(size_t count);
+  void CopyWithChecksum(const char *page_data, char *copy);
+  bool VerifyChecksum(page_id_t page_id, const char *page_data);
+  page_id_t ReserveExtent(page_id_t owner);
+
+  // log file, appended at log_size_
+  int log_fd_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  std::atomic<size_t> log_size_;
+  // db file; there is no shared file cursor, so pages are read and written
+  // by any number of threads at once
   std::string file_name_;
+  int db_fd_;
+  std::atomic<size_t> db_size_; // cached, grows with the writes
+  bool read_only_;
+  // read-only mode: the file as it was when opened, empty if not mapped
+  char *map_ = nullptr;
+  size_t map_size_ = 0;
+  std::atomic<size_t> num_advised_pages_{0};
+  bool direct_io_ = false;      // db_fd_ is O_DIRECT
+  AsyncIO *async_io_ = nullptr;
+  std::once_flag async_io_flag_;
   std::atomic<page_id_t> next_page_id_;
+  // one bit per page, set if allocated; pages_per_bitmap_ is 0 if the file
+  // has no bitmap
+  std::vector<char *> bitmaps_;
+  size_t pages_per_bitmap_ = 0;
+  page_id_t first_free_ = 0; // no free page below
+  // extent each owner allocates from, and the extents reserved that way
+  std::unordered_map<page_id_t, size_t> extents_;
+  std::unordered_set<size_t> reserved_extents_;
+  std::mutex alloc_latch_;
+  uint32_t version_ = 0; // of the file format, 0 without header
+  std::atomic<SyncPolicy> sync_policy_{SyncPolicy::CHECKPOINT};
+  std::atomic<bool> unsynced_{false}; // pages written since the last sync
+  std::atomic<size_t> num_syncs_{0};
+  bool checksums_ = false;
+  std::atomic<bool> verify_checksums_{true};
+  std::atomic<size_t> checksum_failures_{0};
+  size_t page_size_;
+  size_t pool_size_;
+  size_t header_size_; // bytes before page 0, none in files without header
   int num_flushes_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
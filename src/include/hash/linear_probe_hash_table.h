@@ -0,0 +1,56 @@
+/*
+ * linear_probe_hash_table.h : fixed capacity open addressing hash table with
+ * lock-free lookups
+ *
+ * Functionality: Used as the page table of the buffer pool. Every slot holds
+ * an atomic key and an atomic value, so Find never takes a lock and never
+ * sees a torn slot. Insert/Remove must be serialized by the caller (the
+ * buffer pool latch); Remove shifts following entries back instead of leaving
+ * tombstones, so probe sequences never grow over time.
+ *
+ * A concurrent Find may miss a key that is being moved by Remove, or return
+ * the value of a slot that was just reused for another key. Callers must
+ * validate what they found and fall back to a serialized lookup on a miss.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+
+#include "hash/hash_table.h"
+
+namespace cmudb {
+
+template <typename K, typename V>
+class LinearProbeHashTable : public HashTable<K, V> {
+public:
+  // room for at least max_entries keys at load factor <= 1/2; empty_key can
+  // never be inserted
+  LinearProbeHashTable(size_t max_entries, const K &empty_key);
+  ~LinearProbeHashTable();
+
+  // lookup and modifier
+  bool Find(const K &key, V &value) override;
+  bool Remove(const K &key) override;
+  void Insert(const K &key, const V &value) override;
+
+  inline size_t GetCapacity() const { return mask_ + 1; }
+  inline size_t GetSize() const { return size_; }
+
+private:
+  struct Slot {
+    std::atomic<K> key;
+    std::atomic<V> value;
+  };
+
+  // home slot of key
+  size_t HashKey(const K &key) const;
+
+  Slot *slots_;
+  size_t mask_; // capacity - 1, capacity is a power of two
+  K empty_key_;
+  size_t size_;
+};
+
+} // namespace cmudb
@@ -19,11 +19,14 @@ namespace cmudb {
 class LogManager {
 public:
   LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN),
+      : next_lsn_(0), persistent_lsn_(INVALID_LSN), flush_thread_(nullptr),
         disk_manager_(disk_manager) {
     // TODO: you may intialize your own defined memeber variables here
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
+    // sized from the options stored in the database file
+    log_buffer_size_ = LOG_BUFFER_SIZE(disk_manager->GetPageSize(),
+                                       disk_manager->GetPoolSize());
+    log_buffer_ = new char[log_buffer_size_];
+    flush_buffer_ = new char[log_buffer_size_];
   }
 
   ~LogManager() {
@@ -39,10 +42,19 @@ public:
   // append a log record into log buffer
   lsn_t AppendLogRecord(LogRecord &log_record);
 
+  // wake the flush thread and block until the records up to lsn are on
+  // disk, e.g. before a page with that lsn is written back. Return false if
+  // they are not, after LOG_TIMEOUT, since no flush thread is running
+  bool ForceFlush(lsn_t lsn);
+
   // get/set helper functions
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
-  inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
+  inline void SetPersistentLSN(lsn_t lsn) {
+    persistent_lsn_ = lsn;
+    flushed_cv_.notify_all();
+  }
   inline char *GetLogBuffer() { return log_buffer_; }
+  inline size_t GetLogBufferSize() { return log_buffer_size_; }
 
 private:
   // TODO: you may add your own member variables
@@ -55,12 +67,15 @@ private:
   // log buffer related
   char *log_buffer_;
   char *flush_buffer_;
+  size_t log_buffer_size_; // scales with the page size of the database
   // latch to protect shared member variables
   std::mutex latch_;
-  // flush thread
+  // flush thread, nullptr while not running (protected by latch_)
   std::thread *flush_thread_;
   // for notifying flush thread
   std::condition_variable cv_;
+  // for waking up ForceFlush when persistent_lsn_ moves
+  std::condition_variable flushed_cv_;
   // disk manager
   DiskManager *disk_manager_;
 };
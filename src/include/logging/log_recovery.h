@@ -21,7 +21,10 @@ public:
       : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager),
         offset_(0) {
     // global transaction through recovery phase
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
+    // sized from the options stored in the database file
+    log_buffer_size_ = LOG_BUFFER_SIZE(disk_manager->GetPageSize(),
+                                       disk_manager->GetPoolSize());
+    log_buffer_ = new char[log_buffer_size_];
   }
 
   ~LogRecovery() {
@@ -45,6 +48,7 @@ private:
   // log buffer related
   int offset_;
   char *log_buffer_;
+  size_t log_buffer_size_;
 };
 
 } // namespace cmudb
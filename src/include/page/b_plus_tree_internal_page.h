@@ -28,8 +28,10 @@ namespace cmudb {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
 public:
-  // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID);
+  // must call initialize method after "create" a new node. page_size is the
+  // page data size of the buffer pool the node lives in
+  void Init(page_id_t page_id, size_t page_size,
+            page_id_t parent_id = INVALID_PAGE_ID);
 
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
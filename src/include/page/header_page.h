@@ -30,14 +30,14 @@ public:
   bool UpdateRecord(const std::string &name, const page_id_t root_id);
 
   // return root_id if success
-  bool GetRootId(const std::string &name, page_id_t &root_id);
-  int GetRecordCount();
+  bool GetRootId(const std::string &name, page_id_t &root_id) const;
+  int GetRecordCount() const;
 
 private:
   /**
    * helper functions
    */
-  int FindRecord(const std::string &name);
+  int FindRecord(const std::string &name) const;
 
   void SetRecordCount(int record_count);
 };
@@ -4,10 +4,15 @@
  * Wrapper around actual data page in main memory and also contains bookkeeping
  * information used by buffer pool manager like pin_count/dirty_flag/page_id.
  * Use page as a basic unit within the database system
+ *
+ * A Page is the frame descriptor only, the data it points to lives in the
+ * page aligned arena of the buffer pool. Descriptors are cache line aligned
+ * so that pinning one frame does not bounce the line of its neighbours.
  */
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -16,35 +21,59 @@
 
 namespace cmudb {
 
-class Page {
+class alignas(CACHE_LINE_SIZE) Page {
   friend class BufferPoolManager;
+  friend class BufferPoolInstance;
 
 public:
-  Page() { ResetMemory(); }
+  Page() {}
   ~Page(){};
   // get actual data page content
   inline char *GetData() { return data_; }
+  inline const char *GetData() const { return data_; }
+  // get size of the data page in byte
+  inline size_t GetPageSize() { return page_size_; }
+  // bytes of the page a page format may use, the disk manager stores the
+  // checksum of the page behind them
+  inline size_t GetDataSize() { return page_size_ - PAGE_CHECKSUM_SIZE; }
   // get page id
   inline page_id_t GetPageId() { return page_id_; }
-  // get page pin count
-  inline int GetPinCount() { return pin_count_; }
+  // get page pin count (a free frame has none)
+  inline int GetPinCount() { return pin_count_ < 0 ? 0 : int(pin_count_); }
   // method use to latch/unlatch page content
   inline void WUnlatch() { rwlatch_.WUnlock(); }
   inline void WLatch() { rwlatch_.WLock(); }
   inline void RUnlatch() { rwlatch_.RUnlock(); }
   inline void RLatch() { rwlatch_.RLock(); }
+  inline bool TryWLatch() { return rwlatch_.TryWLock(); }
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
 
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + 4); }
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + 4, &lsn, 4); }
 
 private:
   // method used by buffer pool manager
-  inline void ResetMemory() { memset(data_, 0, PAGE_SIZE); }
+  inline void ResetMemory() { memset(data_, 0, page_size_); }
   // members
-  char data_[PAGE_SIZE]; // actual data //include Bplustreeinternalnode
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  int pin_count_ = 0;
+  char *data_ = nullptr; // actual data, owned by the buffer pool
+  size_t page_size_ = PAGE_SIZE;
+  // page_id_, pin_count_ and io_in_progress_ are read by buffer pool hits
+  // that do not take the buffer pool latch
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  // -1 while the frame is free or claimed for a new page
+  std::atomic<int> pin_count_{0};
   bool is_dirty_ = false;
+  // set while the frame is being read from / written back to disk without
+  // holding the buffer pool latch; other users of the frame must wait
+  std::atomic<bool> io_in_progress_{false};
+  // set while the background writer cleans the frame; the page stays usable,
+  // only handing the frame to another page has to wait
+  bool write_back_in_progress_ = false;
+  // not in use since the buffer pool shrank
+  bool retired_ = false;
+  // set by hits that do not take the buffer pool latch, instead of telling
+  // the replacer; the access is passed on by the last unpin
+  std::atomic<bool> accessed_{false};
   RWMutex rwlatch_;
 };
 
@@ -37,9 +37,9 @@ public:
    */
   void Init(page_id_t page_id, size_t page_size, page_id_t prev_page_id,
             LogManager *log_manager, Transaction *txn);
-  page_id_t GetPageId();
-  page_id_t GetPrevPageId();
-  page_id_t GetNextPageId();
+  page_id_t GetPageId() const;
+  page_id_t GetPrevPageId() const;
+  page_id_t GetNextPageId() const;
   void SetPrevPageId(page_id_t prev_page_id);
   void SetNextPageId(page_id_t next_page_id);
 
@@ -49,6 +49,8 @@ public:
   bool InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
                    LockManager *lock_manager,
                    LogManager *log_manager); // return rid if success
+  // whether InsertTuple would find room for tuple
+  bool HasSpaceFor(const Tuple &tuple) const;
   bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager,
                   LogManager *log_manager); // delete
   bool UpdateTuple(const Tuple &new_tuple, Tuple &old_tuple, const RID &rid,
@@ -63,27 +65,28 @@ public:
 
   // return tuple (with data pointing to heap) if success
   bool GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
-                LockManager *lock_manager);
+                LockManager *lock_manager) const;
 
   /**
    * Tuple iterator
    */
-  bool GetFirstTupleRid(RID &first_rid);
-  bool GetNextTupleRid(const RID &cur_rid, RID &next_rid);
+  bool GetFirstTupleRid(RID &first_rid) const;
+  bool GetNextTupleRid(const RID &cur_rid, RID &next_rid) const;
 
 private:
   /**
    * helper functions
    */
-  int32_t GetTupleOffset(int slot_num);
-  int32_t GetTupleSize(int slot_num);
+  int32_t GetTupleOffset(int slot_num) const;
+  int32_t GetTupleSize(int slot_num) const;
   void SetTupleOffset(int slot_num, int32_t offset);
   void SetTupleSize(int slot_num, int32_t offset);
-  int32_t GetFreeSpacePointer(); // offset of the beginning of free space
+  int32_t GetFreeSpacePointer() const; // offset of the beginning of free space
   void SetFreeSpacePointer(int32_t free_space_pointer);
-  int32_t GetTupleCount(); // Note that this tuple count may be larger than # of
-                           // actual tuples because some slots may be empty
+  int32_t GetTupleCount() const; // Note that this tuple count may be larger
+                                 // than # of actual tuples because some
+                                 // slots may be empty
   void SetTupleCount(int32_t tuple_count);
-  int32_t GetFreeSpaceSize();
+  int32_t GetFreeSpaceSize() const;
 };
 } // namespace cmudb
@@ -29,7 +29,9 @@ public:
             LogManager *log_manager, Transaction *txn);
 
   // for insert, if tuple is too large (>~page_size), return false
-  bool InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn);
+  // a bulk load may pass a strategy to keep its pages in a buffer ring
+  bool InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
+                   BufferAccessStrategy *strategy = nullptr);
 
   bool MarkDelete(const RID &rid, Transaction *txn); // for delete
 
@@ -46,12 +48,20 @@ public:
 
   bool DeleteTableHeap();
 
-  TableIterator begin(Transaction *txn);
+  // a large scan may pass a strategy to keep its pages in a buffer ring
+  TableIterator
+  begin(Transaction *txn,
+        std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
 
   TableIterator end();
 
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  // number of pages a scan keeps read ahead of its position, 0 disables it
+  inline void SetReadAheadWindow(size_t window) {
+    read_ahead_window_ = window;
+  }
+
 private:
   /**
    * Members
@@ -60,6 +70,7 @@ private:
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_;
+  size_t read_ahead_window_ = TABLE_READ_AHEAD_PAGES;
 };
 
 } // namespace cmudb
@@ -7,19 +7,26 @@
 #pragma once
 
 #include <cassert>
+#include <deque>
+#include <memory>
+#include <mutex>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "table/tuple.h"
 
 namespace cmudb {
 
+class BufferPoolManager;
 class TableHeap;
+class TablePage;
 
 class TableIterator {
   friend class Cursor;
 
 public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                std::shared_ptr<BufferAccessStrategy> strategy = nullptr);
 
   ~TableIterator() { delete tuple_; }
 
@@ -40,9 +47,35 @@ public:
   TableIterator operator++(int);
 
 private:
+  // pages hinted to the buffer pool ahead of the scan, shared with the
+  // hints in flight: once a hinted page is read, the page it links to is
+  // hinted from there, so the window fills as fast as the pages are read
+  // rather than one page per page scanned
+  struct ReadAheadWindow {
+    std::mutex latch_;
+    std::deque<page_id_t> pages_; // hinted, in chain order
+    // page after the last one hinted, once that one is read
+    page_id_t next_page_id_ = INVALID_PAGE_ID;
+    bool next_known_ = false;
+    size_t generation_ = 0; // changed when the window starts over
+    // pages advised to a memory-mapped file, [advised_begin_, advised_end_)
+    page_id_t advised_begin_ = INVALID_PAGE_ID;
+    page_id_t advised_end_ = INVALID_PAGE_ID;
+  };
+
+  // keep the read-ahead window of the heap in flight past cur_page
+  void ReadAhead(const TablePage *cur_page);
+  // hint the next page if the window has room, caller holds window->latch_
+  static void HintNextPage(std::shared_ptr<ReadAheadWindow> window,
+                           size_t size, BufferPoolManager *buffer_pool_manager,
+                           std::shared_ptr<BufferAccessStrategy> strategy);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  std::shared_ptr<ReadAheadWindow> read_ahead_;
+  // buffer ring the scan reads into, nullptr for the whole pool
+  std::shared_ptr<BufferAccessStrategy> strategy_;
 };
 
 } // namespace cmudb
\ No newline at end of file
@@ -0,0 +1,19 @@
+/**
+ * buffer_pool_stats_table.h
+ *
+ * Read-only virtual table over the statistics of the buffer pool, one row
+ * per buffer pool instance:
+ *   SELECT * FROM bpstats;
+ * The module is registered by sqlite3_vtable_init next to the vtable module,
+ * with the BufferPoolManager of the storage engine as client data.
+ */
+
+#pragma once
+
+#include "sqlite/sqlite3ext.h"
+
+namespace cmudb {
+
+extern sqlite3_module BufferPoolStatsModule;
+
+} // namespace cmudb
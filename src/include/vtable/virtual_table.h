@@ -62,17 +62,25 @@ int VtabBegin(sqlite3_vtab *pVTab);
 // storage engine
 class StorageEngine {
 public:
-  StorageEngine(std::string db_file_name) {
+  // page_size and pool_size apply to a new database file, an existing one
+  // keeps its page size; 0 for the value stored in the file or the default.
+  // direct_io bypasses the OS page cache
+  StorageEngine(std::string db_file_name, size_t page_size = 0,
+                size_t pool_size = 0, bool direct_io = false,
+                bool read_only = false) {
     ENABLE_LOGGING = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    disk_manager_ =
+        new DiskManager(db_file_name, page_size, pool_size, direct_io,
+                        read_only);
 
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
     buffer_pool_manager_ =
-        new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+        new BufferPoolManager(disk_manager_->GetPoolSize(), disk_manager_,
+                              log_manager_, BUFFER_POOL_INSTANCES);
 
     // txn related
     lock_manager_ = new LockManager(true); // S2PL
@@ -82,8 +90,11 @@ public:
   ~StorageEngine() {
     if (ENABLE_LOGGING)
       log_manager_->StopFlushThread();
-    delete disk_manager_;
+    // one sequential pass instead of losing the pages still dirty
+    buffer_pool_manager_->FlushAllPages();
+    // the buffer pool may still be reading pages through the disk manager
     delete buffer_pool_manager_;
+    delete disk_manager_;
     delete log_manager_;
     delete lock_manager_;
     delete transaction_manager_;
@@ -43,4 +43,26 @@ lsn_t LogManager::AppendLogRecord(LogRecord &log_record) {
   return INVALID_LSN;
 }
 
+/*
+ * Used by the buffer pool manager before writing back a page whose LSN is
+ * larger than the persistent LSN. The flush thread moves persistent_lsn_
+ * with SetPersistentLSN; a wake-up lost in between only costs a timeout.
+ * Without a flush thread nothing may ever move it, so the wait gives up
+ * after LOG_TIMEOUT
+ * @return: whether the records up to lsn are on disk
+ */
+bool LogManager::ForceFlush(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  cv_.notify_one();
+  auto deadline = std::chrono::steady_clock::now() + LOG_TIMEOUT;
+  while (ENABLE_LOGGING && persistent_lsn_ < lsn) {
+    if (flush_thread_ != nullptr)
+      flushed_cv_.wait_for(lock, LOG_TIMEOUT);
+    else if (flushed_cv_.wait_until(lock, deadline) ==
+             std::cv_status::timeout)
+      return persistent_lsn_ >= lsn;
+  }
+  return true;
+}
+
 } // namespace cmudb
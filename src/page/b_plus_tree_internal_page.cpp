@@ -19,6 +19,7 @@ namespace cmudb
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
+                                          size_t page_size,
                                           page_id_t parent_id)
 {
     SetPageId(page_id);
@@ -26,7 +27,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id,
     SetPageType(IndexPageType::INTERNAL_PAGE);
     SetSize(1); //when have a key, size = 2, so there is no key and size = 1
 
-    auto ss = (PAGE_SIZE - sizeof(BPlusTreeInternalPage)) / (sizeof(MappingType));
+    auto ss = (page_size - sizeof(BPlusTreeInternalPage)) / (sizeof(MappingType));
     SetMaxSize(ss);
 }
 /*
@@ -160,14 +161,14 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(
     recipient->CopyHalfFrom(array + GetSize() - move_size, move_size, buffer_pool_manager);
 
     for(int i = GetSize() - move_size; i < GetSize(); i++){
-        auto *pp = buffer_pool_manager->FetchPage(array[i].second);
-        if (pp == nullptr)
+        auto pp = buffer_pool_manager->FetchPageWrite(array[i].second);
+        if (!pp.IsValid())
             throw Exception(EXCEPTION_TYPE_INDEX,
                             "all page are pinned while printing");
-        auto *bplus = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(pp->GetData());
+        auto *bplus = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(pp.GetDataMut());
         bplus->SetParentPageId(recipient->GetPageId());
 
-        buffer_pool_manager->UnpinPage(bplus->GetPageId(), true);
+        pp.Drop();
     }
     IncreaseSize(-move_size);
 }
@@ -223,23 +224,23 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(
     BPlusTreeInternalPage *recipient, int index_in_parent,
     BufferPoolManager *buffer_pool_manager)
 {
-    auto *parent_page = buffer_pool_manager->FetchPage(GetParentPageId());
-    if (parent_page == nullptr)
+    auto parent_page = buffer_pool_manager->FetchPageWrite(GetParentPageId());
+    if (!parent_page.IsValid())
             throw Exception(EXCEPTION_TYPE_INDEX,
                             "all page are pinned while printing");
-    auto *bplus_parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(parent_page->GetData());
+    auto *bplus_parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(parent_page.GetDataMut());
     array[0].first = bplus_parent->KeyAt(index_in_parent);
     bplus_parent->Remove(index_in_parent);
-    buffer_pool_manager->UnpinPage(GetParentPageId(), true);
+    parent_page.Drop();
     recipient->CopyAllFrom(array, GetSize(), buffer_pool_manager);
     for(int i = 0; i < GetSize(); i++){
-        auto *pp = buffer_pool_manager->FetchPage(array[i].second);
-        if (pp == nullptr)
+        auto pp = buffer_pool_manager->FetchPageWrite(array[i].second);
+        if (!pp.IsValid())
             throw Exception(EXCEPTION_TYPE_INDEX,
                             "all page are pinned while printing");
-        auto *bplus = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(pp->GetData());
+        auto *bplus = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(pp.GetDataMut());
         bplus->SetParentPageId(index_in_parent);
-        buffer_pool_manager->UnpinPage(bplus->GetPageId(), true);
+        pp.Drop();
     }
     SetSize(1);
 }
@@ -266,23 +267,23 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(
     BPlusTreeInternalPage *recipient,
     BufferPoolManager *buffer_pool_manager)
 {
-    auto *parent_page = buffer_pool_manager->FetchPage(GetParentPageId());
-    if (parent_page == nullptr)
+    auto parent_page = buffer_pool_manager->FetchPageWrite(GetParentPageId());
+    if (!parent_page.IsValid())
             throw Exception(EXCEPTION_TYPE_INDEX,
                             "all page are pinned while printing");
-    auto *bplus_parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(parent_page->GetData());
+    auto *bplus_parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(parent_page.GetDataMut());
     array[0].first = bplus_parent->KeyAt(bplus_parent->ValueIndex(GetPageId()));
     bplus_parent->SetKeyAt(bplus_parent->ValueIndex(GetPageId()), array[1].first);
-    buffer_pool_manager->UnpinPage(GetParentPageId(), true);
+    parent_page.Drop();
 
     recipient->CopyLastFrom(array[0], buffer_pool_manager);
-    auto *pp = buffer_pool_manager->FetchPage(array[0].second);
-    if (pp == nullptr)
+    auto pp = buffer_pool_manager->FetchPageWrite(array[0].second);
+    if (!pp.IsValid())
             throw Exception(EXCEPTION_TYPE_INDEX,
                             "all page are pinned while printing");
-    auto *bplus = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(pp->GetData());
+    auto *bplus = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(pp.GetDataMut());
     bplus->SetParentPageId(recipient->GetPageId());
-    buffer_pool_manager->UnpinPage(GetPageId(), true);
+    pp.Drop();
     for(int i = 1; i < GetSize(); i++){
         array[i - 1] = array[i];
     }
@@ -306,22 +307,22 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(
     BPlusTreeInternalPage *recipient, int parent_index,
     BufferPoolManager *buffer_pool_manager)
 {
-    auto *parent_page = buffer_pool_manager->FetchPage(GetParentPageId());
-    if (parent_page == nullptr)
+    auto parent_page = buffer_pool_manager->FetchPageWrite(GetParentPageId());
+    if (!parent_page.IsValid())
             throw Exception(EXCEPTION_TYPE_INDEX,
                             "all page are pinned while printing");
-    auto *bplus_parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(parent_page->GetData());
+    auto *bplus_parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(parent_page.GetDataMut());
     bplus_parent->SetKeyAt(bplus_parent->ValueIndex(GetPageId()), array[GetSize() - 1].first);
-    buffer_pool_manager->UnpinPage(GetParentPageId(), true);
+    parent_page.Drop();
 
     recipient->CopyLastFrom(array[GetSize() - 1], buffer_pool_manager);
-    auto *pp = buffer_pool_manager->FetchPage(array[GetSize() - 1].second);
-    if (pp == nullptr)
+    auto pp = buffer_pool_manager->FetchPageWrite(array[GetSize() - 1].second);
+    if (!pp.IsValid())
             throw Exception(EXCEPTION_TYPE_INDEX,
                             "all page are pinned while printing");
-    auto *bplus = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(pp->GetData());
+    auto *bplus = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(pp.GetDataMut());
     bplus->SetParentPageId(recipient->GetPageId());
-    buffer_pool_manager->UnpinPage(GetPageId(), true);
+    pp.Drop();
     IncreaseSize(-1);
 }
 
@@ -21,14 +21,15 @@ namespace cmudb
  * next page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id)
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, size_t page_size,
+                                      page_id_t parent_id)
 {
     SetPageId(page_id);
     SetParentPageId(parent_id);
     SetPageType(IndexPageType::LEAF_PAGE);
     SetSize(0); //when have a key, size = 2, so there is no key and size = 1
 
-    auto ss = (PAGE_SIZE - sizeof(BPlusTreeLeafPage)) / (sizeof(MappingType));
+    auto ss = (page_size - sizeof(BPlusTreeLeafPage)) / (sizeof(MappingType));
     SetMaxSize(ss);
 }
 
@@ -239,13 +240,13 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(
     BPlusTreeLeafPage *recipient,
     BufferPoolManager *buffer_pool_manager)
 {
-    auto *parent_page = buffer_pool_manager->FetchPage(GetParentPageId());
-    if (parent_page == nullptr)
+    auto parent_page = buffer_pool_manager->FetchPageWrite(GetParentPageId());
+    if (!parent_page.IsValid())
             throw Exception(EXCEPTION_TYPE_INDEX,
                             "all page are pinned while printing");
-    auto *bplus_parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(parent_page->GetData());
+    auto *bplus_parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(parent_page.GetDataMut());
     bplus_parent->SetKeyAt(bplus_parent->ValueIndex(GetPageId()), array[1].first);
-    buffer_pool_manager->UnpinPage(GetParentPageId(), true);
+    parent_page.Drop();
 
     recipient->CopyLastFrom(array[0]);
     for(int i = 1; i < GetSize(); i++){
@@ -269,13 +270,13 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(
     BPlusTreeLeafPage *recipient, int parentIndex,
     BufferPoolManager *buffer_pool_manager)
 {
-    auto *parent_page = buffer_pool_manager->FetchPage(GetParentPageId());
-    if (parent_page == nullptr)
+    auto parent_page = buffer_pool_manager->FetchPageWrite(GetParentPageId());
+    if (!parent_page.IsValid())
             throw Exception(EXCEPTION_TYPE_INDEX,
                             "all page are pinned while printing");
-    auto *bplus_parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(parent_page->GetData());
+    auto *bplus_parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(parent_page.GetDataMut());
     bplus_parent->SetKeyAt(parentIndex, array[GetSize() - 1].first);
-    buffer_pool_manager->UnpinPage(GetParentPageId(), true);
+    parent_page.Drop();
     
     recipient->CopyFirstFrom(array[GetSize() - 1], parentIndex, buffer_pool_manager);
     IncreaseSize(-1);
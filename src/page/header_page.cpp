@@ -18,6 +18,9 @@ bool HeaderPage::InsertRecord(const std::string &name,
 
   int record_num = GetRecordCount();
   int offset = 4 + record_num * 36;
+  // page is full
+  if (offset + 36 > static_cast<int>(GetDataSize()))
+    return false;
   // check for duplicate name
   if (FindRecord(name) != -1)
     return false;
@@ -60,7 +63,8 @@ bool HeaderPage::UpdateRecord(const std::string &name,
   return true;
 }
 
-bool HeaderPage::GetRootId(const std::string &name, page_id_t &root_id) {
+bool HeaderPage::GetRootId(const std::string &name,
+                           page_id_t &root_id) const {
   assert(name.length() < 32);
 
   int index = FindRecord(name);
@@ -68,7 +72,7 @@ bool HeaderPage::GetRootId(const std::string &name, page_id_t &root_id) {
   if (index == -1)
     return false;
   int offset = (index + 1) * 36;
-  root_id = *reinterpret_cast<page_id_t *>(GetData() + offset);
+  root_id = *reinterpret_cast<const page_id_t *>(GetData() + offset);
 
   return true;
 }
@@ -77,17 +81,19 @@ bool HeaderPage::GetRootId(const std::string &name, page_id_t &root_id) {
  * helper functions
  */
 // record count
-int HeaderPage::GetRecordCount() { return *reinterpret_cast<int *>(GetData()); }
+int HeaderPage::GetRecordCount() const {
+  return *reinterpret_cast<const int *>(GetData());
+}
 
 void HeaderPage::SetRecordCount(int record_count) {
   memcpy(GetData(), &record_count, 4);
 }
 
-int HeaderPage::FindRecord(const std::string &name) {
+int HeaderPage::FindRecord(const std::string &name) const {
   int record_num = GetRecordCount();
 
   for (int i = 0; i < record_num; i++) {
-    char *raw_name = reinterpret_cast<char *>(GetData() + (4 + i * 36));
+    const char *raw_name = GetData() + (4 + i * 36);
     if (strcmp(raw_name, name.c_str()) == 0)
       return i;
   }
@@ -23,16 +23,16 @@ void TablePage::Init(page_id_t page_id, size_t page_size,
   SetTupleCount(0);
 }
 
-page_id_t TablePage::GetPageId() {
-  return *reinterpret_cast<page_id_t *>(GetData());
+page_id_t TablePage::GetPageId() const {
+  return *reinterpret_cast<const page_id_t *>(GetData());
 }
 
-page_id_t TablePage::GetPrevPageId() {
-  return *reinterpret_cast<page_id_t *>(GetData() + 8);
+page_id_t TablePage::GetPrevPageId() const {
+  return *reinterpret_cast<const page_id_t *>(GetData() + 8);
 }
 
-page_id_t TablePage::GetNextPageId() {
-  return *reinterpret_cast<page_id_t *>(GetData() + 12);
+page_id_t TablePage::GetNextPageId() const {
+  return *reinterpret_cast<const page_id_t *>(GetData() + 12);
 }
 
 void TablePage::SetPrevPageId(page_id_t prev_page_id) {
@@ -93,6 +93,22 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
   return true;
 }
 
+/*
+ * Same space checks as InsertTuple, without writing the page
+ */
+bool TablePage::HasSpaceFor(const Tuple &tuple) const {
+  if (GetFreeSpaceSize() >= tuple.size_ + 8)
+    return true;
+  if (GetFreeSpaceSize() < tuple.size_)
+    return false;
+  // the tuple fits only into a free slot
+  for (int i = 0; i < GetTupleCount(); ++i) {
+    if (GetTupleSize(i) == 0)
+      return true;
+  }
+  return false;
+}
+
 /*
  * MarkDelete method does not truly delete a tuple from table page
  * Instead it set the tuple as 'deleted' by changing the tuple size metadata to
@@ -279,7 +295,7 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn,
 }
 
 bool TablePage::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
-                         LockManager *lock_manager) {
+                         LockManager *lock_manager) const {
   int slot_num = rid.GetSlotNum();
   if (slot_num >= GetTupleCount()) {
     if (ENABLE_LOGGING)
@@ -317,7 +333,7 @@ bool TablePage::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn,
 /**
  * Tuple iterator
  */
-bool TablePage::GetFirstTupleRid(RID &first_rid) {
+bool TablePage::GetFirstTupleRid(RID &first_rid) const {
   for (int i = 0; i < GetTupleCount(); ++i) {
     if (GetTupleSize(i) > 0) { // valid tuple
       first_rid.Set(GetPageId(), i);
@@ -329,7 +345,7 @@ bool TablePage::GetFirstTupleRid(RID &first_rid) {
   return false;
 }
 
-bool TablePage::GetNextTupleRid(const RID &cur_rid, RID &next_rid) {
+bool TablePage::GetNextTupleRid(const RID &cur_rid, RID &next_rid) const {
   assert(cur_rid.GetPageId() == GetPageId());
   for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
     if (GetTupleSize(i) > 0) { // valid tuple
@@ -345,12 +361,12 @@ bool TablePage::GetNextTupleRid(const RID &cur_rid, RID &next_rid) {
  */
 
 // tuple slots
-int32_t TablePage::GetTupleOffset(int slot_num) {
-  return *reinterpret_cast<int32_t *>(GetData() + 24 + 8 * slot_num);
+int32_t TablePage::GetTupleOffset(int slot_num) const {
+  return *reinterpret_cast<const int32_t *>(GetData() + 24 + 8 * slot_num);
 }
 
-int32_t TablePage::GetTupleSize(int slot_num) {
-  return *reinterpret_cast<int32_t *>(GetData() + 28 + 8 * slot_num);
+int32_t TablePage::GetTupleSize(int slot_num) const {
+  return *reinterpret_cast<const int32_t *>(GetData() + 28 + 8 * slot_num);
 }
 
 void TablePage::SetTupleOffset(int slot_num, int32_t offset) {
@@ -362,8 +378,8 @@ void TablePage::SetTupleSize(int slot_num, int32_t offset) {
 }
 
 // free space
-int32_t TablePage::GetFreeSpacePointer() {
-  return *reinterpret_cast<int32_t *>(GetData() + 16);
+int32_t TablePage::GetFreeSpacePointer() const {
+  return *reinterpret_cast<const int32_t *>(GetData() + 16);
 }
 
 void TablePage::SetFreeSpacePointer(int32_t free_space_pointer) {
@@ -371,8 +387,8 @@ void TablePage::SetFreeSpacePointer(int32_t free_space_pointer) {
 }
 
 // tuple count
-int32_t TablePage::GetTupleCount() {
-  return *reinterpret_cast<int32_t *>(GetData() + 20);
+int32_t TablePage::GetTupleCount() const {
+  return *reinterpret_cast<const int32_t *>(GetData() + 20);
 }
 
 void TablePage::SetTupleCount(int32_t tuple_count) {
@@ -380,7 +396,7 @@ void TablePage::SetTupleCount(int32_t tuple_count) {
 }
 
 // for free space calculation
-int32_t TablePage::GetFreeSpaceSize() {
+int32_t TablePage::GetFreeSpaceSize() const {
   return GetFreeSpacePointer() - 24 - GetTupleCount() * 8;
 }
 } // namespace cmudb
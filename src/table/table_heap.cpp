@@ -22,136 +22,109 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager,
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
       log_manager_(log_manager) {
-  auto first_page =
-      static_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_));
-  assert(first_page != nullptr); // todo: abort table creation?
-  first_page->WLatch();
+  auto first_page = buffer_pool_manager_->NewPageGuarded(first_page_id_);
+  assert(first_page.IsValid()); // todo: abort table creation?
   LOG_DEBUG("new table page created %d", first_page_id_);
 
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
-  first_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  first_page.AsMut<TablePage>()->Init(first_page_id_,
+                                      buffer_pool_manager_->GetPageDataSize(),
+                                      INVALID_LSN, log_manager_, txn);
 }
 
-bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) { // larger than one page size
+bool TableHeap::InsertTuple(const Tuple &tuple, RID &rid, Transaction *txn,
+                            BufferAccessStrategy *strategy) {
+  // larger than one page size
+  if (tuple.size_ + 32 >
+      static_cast<int32_t>(buffer_pool_manager_->GetPageDataSize())) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page =
-      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  auto cur_page = buffer_pool_manager_->FetchPageWrite(first_page_id_, strategy);
+  if (!cur_page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  cur_page->WLatch();
-  while (!cur_page->InsertTuple(
-      tuple, rid, txn, lock_manager_,
-      log_manager_)) { // fail to insert due to not enough space
-    auto next_page_id = cur_page->GetNextPageId();
+  // look for room without writing, the full pages passed stay clean
+  while (!cur_page.As<TablePage>()->HasSpaceFor(tuple)) {
+    auto next_page_id = cur_page.As<TablePage>()->GetNextPageId();
     if (next_page_id != INVALID_PAGE_ID) { // valid next page
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
-      cur_page = static_cast<TablePage *>(
-          buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
+      cur_page = buffer_pool_manager_->FetchPageWrite(next_page_id, strategy);
     } else { // create new page
-      auto new_page =
-          static_cast<TablePage *>(buffer_pool_manager_->NewPage(next_page_id));
-      if (new_page == nullptr) {
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), false);
+      // pages of the heap follow each other on disk, for scans
+      auto new_page = buffer_pool_manager_->NewPageGuarded(
+          next_page_id, strategy, first_page_id_);
+      if (!new_page.IsValid()) {
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
-      new_page->WLatch();
       // std::cout << "new table page " << next_page_id << " created" <<
       // std::endl;
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetPageId(),
-                     log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
-      cur_page = new_page;
+      cur_page.AsMut<TablePage>()->SetNextPageId(next_page_id);
+      new_page.AsMut<TablePage>()->Init(
+          next_page_id, buffer_pool_manager_->GetPageDataSize(),
+          cur_page.GetPageId(), log_manager_, txn);
+      cur_page = std::move(new_page);
     }
   }
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetPageId(), true);
+  cur_page.AsMut<TablePage>()->InsertTuple(tuple, rid, txn, lock_manager_,
+                                           log_manager_);
+  cur_page.Drop();
   txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // todo: remove empty page
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if (page == nullptr) {
+  auto page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  page.AsMut<TablePage>()->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  page.Drop();
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
 }
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid,
                             Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if (page == nullptr) {
+  auto page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  if (!page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   Tuple old_tuple;
-  page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, old_tuple, rid, txn, lock_manager_,
-                                      log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_updated);
+  bool is_updated = page.AsMut<TablePage>()->UpdateTuple(
+      tuple, old_tuple, rid, txn, lock_manager_, log_manager_);
+  page.Drop();
   if (is_updated && txn->GetState() != TransactionState::ABORTED)
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
   return is_updated;
 }
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  assert(page != nullptr);
-  page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  auto page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  assert(page.IsValid());
+  page.AsMut<TablePage>()->ApplyDelete(rid, txn, log_manager_);
   lock_manager_->Unlock(txn, rid);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
-  auto page = reinterpret_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  assert(page != nullptr);
-  page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  auto page = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+  assert(page.IsValid());
+  page.AsMut<TablePage>()->RollbackDelete(rid, txn, log_manager_);
 }
 
 // called by tuple iterator
 bool TableHeap::GetTuple(const RID &rid, Tuple &tuple, Transaction *txn) {
-  auto page = static_cast<TablePage *>(
-      buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if (page == nullptr) {
+  auto page = buffer_pool_manager_->FetchPageRead(rid.GetPageId());
+  if (!page.IsValid()) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
-  return res;
+  return page.As<TablePage>()->GetTuple(rid, tuple, txn, lock_manager_);
 }
 
 bool TableHeap::DeleteTableHeap() {
@@ -159,17 +132,18 @@ bool TableHeap::DeleteTableHeap() {
   return true;
 }
 
-TableIterator TableHeap::begin(Transaction *txn) {
-  auto page =
-      static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  page->RLatch();
+TableIterator
+TableHeap::begin(Transaction *txn,
+                 std::shared_ptr<BufferAccessStrategy> strategy) {
   RID rid;
-  // if failed (no tuple), rid will be the result of default
-  // constructor, which means eof
-  page->GetFirstTupleRid(rid);
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, false);
-  return TableIterator(this, rid, txn);
+  {
+    auto page =
+        buffer_pool_manager_->FetchPageRead(first_page_id_, strategy.get());
+    // if failed (no tuple), rid will be the result of default
+    // constructor, which means eof
+    page.As<TablePage>()->GetFirstTupleRid(rid);
+  }
+  return TableIterator(this, rid, txn, std::move(strategy));
 }
 
 TableIterator TableHeap::end() {
@@ -8,10 +8,23 @@
 
 namespace cmudb {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn,
+                             std::shared_ptr<BufferAccessStrategy> strategy)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn),
+      read_ahead_(std::make_shared<ReadAheadWindow>()),
+      strategy_(std::move(strategy)) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+    // start reading ahead of the first page of the scan
+    auto page = static_cast<TablePage *>(
+        table_heap_->buffer_pool_manager_->FetchResidentPage(
+            rid.GetPageId()));
+    if (page != nullptr) {
+      page->RLatch();
+      ReadAhead(page);
+      page->RUnlatch();
+      table_heap_->buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
   }
 };
 
@@ -27,36 +40,96 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(
-      buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr); // all pages are pinned
+  auto cur_page = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId(),
+                                                     strategy_.get());
+  assert(cur_page.IsValid()); // all pages are pinned
 
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 next_tuple_rid)) { // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(
-          buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(next_tuple_rid))
+  if (!cur_page.As<TablePage>()->GetNextTupleRid(
+          tuple_->rid_, next_tuple_rid)) { // end of this page
+    while (cur_page.As<TablePage>()->GetNextPageId() != INVALID_PAGE_ID) {
+      cur_page = buffer_pool_manager->FetchPageRead(
+          cur_page.As<TablePage>()->GetNextPageId(), strategy_.get());
+      ReadAhead(cur_page.As<TablePage>());
+      if (cur_page.As<TablePage>()->GetFirstTupleRid(next_tuple_rid))
         break;
     }
   }
   tuple_->rid_ = next_tuple_rid;
 
+  // read the tuple from the page still latched, instead of fetching it again
   if (*this != table_heap_->end()) {
-    table_heap_->GetTuple(tuple_->rid_, *tuple_, txn_);
+    cur_page.As<TablePage>()->GetTuple(tuple_->rid_, *tuple_, txn_,
+                                       table_heap_->lock_manager_);
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
   return *this;
 }
 
+/*
+ * Hint the pages after cur_page (latched by caller) to the buffer pool,
+ * until read_ahead_window_ of them are in flight. The next page id of a
+ * hinted page is only known once it is read, so each hint follows the
+ * chain from the I/O thread when its page arrives; the scan never waits on
+ * its own read-ahead. A memory-mapped file is advised of a whole window of
+ * pages at once, when the scan moves past the pages advised before
+ */
+void TableIterator::ReadAhead(const TablePage *cur_page) {
+  std::lock_guard<std::mutex> guard(read_ahead_->latch_);
+  std::deque<page_id_t> &pages = read_ahead_->pages_;
+  // drop what has been reached; the chain changed if cur_page is not next
+  if (!pages.empty() && pages.front() == cur_page->GetPageId())
+    pages.pop_front();
+  else
+    pages.clear();
+  if (pages.empty()) {
+    // start over from cur_page, also when a hint got lost on the way
+    read_ahead_->generation_++;
+    read_ahead_->next_page_id_ = cur_page->GetNextPageId();
+    read_ahead_->next_known_ = true;
+  }
+  page_id_t next_page_id = cur_page->GetNextPageId();
+  size_t size = table_heap_->read_ahead_window_;
+  if (next_page_id != INVALID_PAGE_ID && size > 0 &&
+      (next_page_id < read_ahead_->advised_begin_ ||
+       next_page_id >= read_ahead_->advised_end_)) {
+    table_heap_->buffer_pool_manager_->AdviseSequential(next_page_id, size);
+    read_ahead_->advised_begin_ = next_page_id;
+    read_ahead_->advised_end_ = next_page_id + page_id_t(size);
+  }
+  HintNextPage(read_ahead_, size, table_heap_->buffer_pool_manager_,
+               strategy_);
+}
+
+void TableIterator::HintNextPage(
+    std::shared_ptr<ReadAheadWindow> window, size_t size,
+    BufferPoolManager *buffer_pool_manager,
+    std::shared_ptr<BufferAccessStrategy> strategy) {
+  if (!window->next_known_ || window->next_page_id_ == INVALID_PAGE_ID ||
+      window->pages_.size() >= size)
+    return;
+  page_id_t page_id = window->next_page_id_;
+  size_t generation = window->generation_;
+  window->pages_.push_back(page_id);
+  window->next_known_ = false;
+  buffer_pool_manager->PrefetchPage(
+      page_id, strategy,
+      [=](Page *page) {
+        // on an I/O thread, which must not wait for a writer of the page
+        if (!page->TryRLatch())
+          return;
+        page_id_t next_page_id =
+            static_cast<TablePage *>(page)->GetNextPageId();
+        page->RUnlatch();
+        std::lock_guard<std::mutex> guard(window->latch_);
+        if (window->generation_ != generation || window->pages_.empty() ||
+            window->pages_.back() != page_id)
+          return;
+        window->next_page_id_ = next_page_id;
+        window->next_known_ = true;
+        HintNextPage(window, size, buffer_pool_manager, strategy);
+      });
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
@@ -0,0 +1,219 @@
+/**
+ * buffer_pool_stats_table.cpp
+ */
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "vtable/buffer_pool_stats_table.h"
+
+namespace cmudb {
+
+SQLITE_EXTENSION_INIT3
+
+enum StatsColumnIndex {
+  STATS_INSTANCE = 0,
+  STATS_HITS,
+  STATS_MISSES,
+  STATS_HIT_RATIO,
+  STATS_EVICTIONS,
+  STATS_DIRTY_EVICTIONS,
+  STATS_WRITE_BACKS,
+  STATS_FLUSHES,
+  STATS_PREFETCHES,
+  STATS_WARM_UPS,
+  STATS_LOG_FORCES,
+  STATS_READS,
+  STATS_READ_AVG_NS,
+  STATS_READ_P99_NS,
+  STATS_WRITES,
+  STATS_WRITE_AVG_NS,
+  STATS_WRITE_P99_NS,
+  STATS_LATCH_WAITS,
+  STATS_LATCH_WAIT_NS,
+  STATS_PAGE_LATCH_WAITS,
+  STATS_PAGE_LATCH_WAIT_NS
+};
+
+static const char *STATS_SCHEMA =
+    "CREATE TABLE X(instance INTEGER, hits INTEGER, misses INTEGER, "
+    "hit_ratio REAL, evictions INTEGER, dirty_evictions INTEGER, "
+    "write_backs INTEGER, flushes INTEGER, prefetches INTEGER, "
+    "warm_ups INTEGER, log_forces INTEGER, reads INTEGER, read_avg_ns REAL, "
+    "read_p99_ns INTEGER, writes INTEGER, write_avg_ns REAL, "
+    "write_p99_ns INTEGER, latch_waits INTEGER, latch_wait_ns INTEGER, "
+    "page_latch_waits INTEGER, page_latch_wait_ns INTEGER);";
+
+struct StatsTable {
+  sqlite3_vtab base_;
+  BufferPoolManager *buffer_pool_manager_;
+};
+
+struct StatsCursor {
+  sqlite3_vtab_cursor base_;
+  // snapshot taken when the scan starts, so a row is consistent in itself
+  std::vector<BufferPoolStats> rows_;
+  size_t row_;
+};
+
+/* API implementation */
+int StatsConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
+                 sqlite3_vtab **ppVtab, char **pzErr) {
+  int rc = sqlite3_declare_vtab(db, STATS_SCHEMA);
+  if (rc != SQLITE_OK)
+    return rc;
+  StatsTable *table = new StatsTable();
+  table->buffer_pool_manager_ = static_cast<BufferPoolManager *>(pAux);
+  *ppVtab = reinterpret_cast<sqlite3_vtab *>(table);
+  return SQLITE_OK;
+}
+
+int StatsBestIndex(sqlite3_vtab *tab, sqlite3_index_info *pIdxInfo) {
+  // always a full scan over a handful of rows
+  pIdxInfo->estimatedCost = 1;
+  return SQLITE_OK;
+}
+
+int StatsDisconnect(sqlite3_vtab *pVtab) {
+  delete reinterpret_cast<StatsTable *>(pVtab);
+  return SQLITE_OK;
+}
+
+int StatsOpen(sqlite3_vtab *pVtab, sqlite3_vtab_cursor **ppCursor) {
+  StatsCursor *cursor = new StatsCursor();
+  *ppCursor = reinterpret_cast<sqlite3_vtab_cursor *>(cursor);
+  return SQLITE_OK;
+}
+
+int StatsClose(sqlite3_vtab_cursor *cur) {
+  delete reinterpret_cast<StatsCursor *>(cur);
+  return SQLITE_OK;
+}
+
+int StatsFilter(sqlite3_vtab_cursor *pVtabCursor, int idxNum,
+                const char *idxStr, int argc, sqlite3_value **argv) {
+  StatsCursor *cursor = reinterpret_cast<StatsCursor *>(pVtabCursor);
+  BufferPoolManager *buffer_pool_manager =
+      reinterpret_cast<StatsTable *>(pVtabCursor->pVtab)->buffer_pool_manager_;
+  cursor->rows_.clear();
+  cursor->row_ = 0;
+  for (size_t i = 0; i < buffer_pool_manager->GetNumInstances(); i++)
+    cursor->rows_.push_back(buffer_pool_manager->GetStats(i));
+  return SQLITE_OK;
+}
+
+int StatsNext(sqlite3_vtab_cursor *cur) {
+  reinterpret_cast<StatsCursor *>(cur)->row_++;
+  return SQLITE_OK;
+}
+
+int StatsEof(sqlite3_vtab_cursor *cur) {
+  StatsCursor *cursor = reinterpret_cast<StatsCursor *>(cur);
+  return cursor->row_ >= cursor->rows_.size();
+}
+
+int StatsColumn(sqlite3_vtab_cursor *cur, sqlite3_context *ctx, int i) {
+  StatsCursor *cursor = reinterpret_cast<StatsCursor *>(cur);
+  const BufferPoolStats &stats = cursor->rows_[cursor->row_];
+  switch (i) {
+  case STATS_INSTANCE:
+    sqlite3_result_int64(ctx, cursor->row_);
+    break;
+  case STATS_HITS:
+    sqlite3_result_int64(ctx, stats.Get(BufferPoolEvent::HIT));
+    break;
+  case STATS_MISSES:
+    sqlite3_result_int64(ctx, stats.Get(BufferPoolEvent::MISS));
+    break;
+  case STATS_HIT_RATIO:
+    sqlite3_result_double(ctx, stats.GetHitRatio());
+    break;
+  case STATS_EVICTIONS:
+    sqlite3_result_int64(ctx, stats.Get(BufferPoolEvent::EVICTION));
+    break;
+  case STATS_DIRTY_EVICTIONS:
+    sqlite3_result_int64(ctx, stats.Get(BufferPoolEvent::DIRTY_EVICTION));
+    break;
+  case STATS_WRITE_BACKS:
+    sqlite3_result_int64(ctx, stats.Get(BufferPoolEvent::WRITE_BACK));
+    break;
+  case STATS_FLUSHES:
+    sqlite3_result_int64(ctx, stats.Get(BufferPoolEvent::FLUSH));
+    break;
+  case STATS_PREFETCHES:
+    sqlite3_result_int64(ctx, stats.Get(BufferPoolEvent::PREFETCH));
+    break;
+  case STATS_WARM_UPS:
+    sqlite3_result_int64(ctx, stats.Get(BufferPoolEvent::WARM_UP));
+    break;
+  case STATS_LOG_FORCES:
+    sqlite3_result_int64(ctx, stats.Get(BufferPoolEvent::LOG_FORCE));
+    break;
+  case STATS_READS:
+    sqlite3_result_int64(ctx, stats.read_latency_.count_);
+    break;
+  case STATS_READ_AVG_NS:
+    sqlite3_result_double(ctx, stats.read_latency_.GetMean());
+    break;
+  case STATS_READ_P99_NS:
+    sqlite3_result_int64(ctx, stats.read_latency_.GetPercentile(0.99));
+    break;
+  case STATS_WRITES:
+    sqlite3_result_int64(ctx, stats.write_latency_.count_);
+    break;
+  case STATS_WRITE_AVG_NS:
+    sqlite3_result_double(ctx, stats.write_latency_.GetMean());
+    break;
+  case STATS_WRITE_P99_NS:
+    sqlite3_result_int64(ctx, stats.write_latency_.GetPercentile(0.99));
+    break;
+  case STATS_LATCH_WAITS:
+    sqlite3_result_int64(ctx, stats.latch_wait_.count_);
+    break;
+  case STATS_LATCH_WAIT_NS:
+    sqlite3_result_int64(ctx, stats.latch_wait_.sum_);
+    break;
+  case STATS_PAGE_LATCH_WAITS:
+    sqlite3_result_int64(ctx, stats.page_latch_wait_.count_);
+    break;
+  case STATS_PAGE_LATCH_WAIT_NS:
+    sqlite3_result_int64(ctx, stats.page_latch_wait_.sum_);
+    break;
+  default:
+    return SQLITE_ERROR;
+  }
+  return SQLITE_OK;
+}
+
+int StatsRowid(sqlite3_vtab_cursor *cur, sqlite3_int64 *pRowid) {
+  *pRowid = reinterpret_cast<StatsCursor *>(cur)->row_;
+  return SQLITE_OK;
+}
+
+// no xUpdate: sqlite rejects writes to the table
+sqlite3_module BufferPoolStatsModule = {
+    0,               /* iVersion */
+    StatsConnect,    /* xCreate */
+    StatsConnect,    /* xConnect */
+    StatsBestIndex,  /* xBestIndex */
+    StatsDisconnect, /* xDisconnect */
+    StatsDisconnect, /* xDestroy */
+    StatsOpen,       /* xOpen - open a cursor */
+    StatsClose,      /* xClose - close a cursor */
+    StatsFilter,     /* xFilter - configure scan constraints */
+    StatsNext,       /* xNext - advance a cursor */
+    StatsEof,        /* xEof - check for end of scan */
+    StatsColumn,     /* xColumn - read data */
+    StatsRowid,      /* xRowid - read data */
+    0,               /* xUpdate */
+    0,               /* xBegin */
+    0,               /* xSync */
+    0,               /* xCommit */
+    0,               /* xRollback */
+    0,               /* xFindMethod */
+    0,               /* xRename */
+    0,               /* xSavepoint */
+    0,               /* xRelease */
+    0,               /* xRollbackTo */
+};
+
+} // namespace cmudb
@@ -11,6 +11,7 @@
 #include "common/logger.h"
 #include "common/string_utility.h"
 #include "page/header_page.h"
+#include "vtable/buffer_pool_stats_table.h"
 #include "vtable/virtual_table.h"
 
 namespace cmudb {
@@ -25,10 +26,6 @@ int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   LockManager *lock_manager = storage_engine_->lock_manager_;
   LogManager *log_manager = storage_engine_->log_manager_;
 
-  // fetch header page from buffer pool
-  HeaderPage *header_page =
-      static_cast<HeaderPage *>(buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
-
   // the first three parameter:(1) module name (2) database name (3)table name
   assert(argc >= 4);
   // parse arg[3](string that defines table schema)
@@ -50,9 +47,10 @@ int VtabCreate(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   VirtualTable *table = new VirtualTable(schema, buffer_pool_manager,
                                          lock_manager, log_manager, index);
 
-  // insert table root page info into header page
-  header_page->InsertRecord(std::string(argv[2]), table->GetFirstPageId());
-  buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, true);
+  // insert table root page info into header page, only pinned for that
+  buffer_pool_manager->FetchPageWrite(HEADER_PAGE_ID)
+      .AsMut<HeaderPage>()
+      ->InsertRecord(std::string(argv[2]), table->GetFirstPageId());
 
   // register virtual table within sqlite system
   schema_string = "CREATE TABLE X(" + schema_string + ");";
@@ -77,8 +75,8 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   LogManager *log_manager = storage_engine_->log_manager_;
 
   // Retrieve table root page info from header page
-  HeaderPage *header_page =
-      static_cast<HeaderPage *>(buffer_pool_manager->FetchPage(HEADER_PAGE_ID));
+  auto header_guard = buffer_pool_manager->FetchPageRead(HEADER_PAGE_ID);
+  const HeaderPage *header_page = header_guard.As<HeaderPage>();
   page_id_t table_root_id;
   header_page->GetRootId(std::string(argv[2]), table_root_id);
   // parse arg[4](string that defines table index)
@@ -92,8 +90,10 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
     // Retrieve index root page info from header page
     page_id_t index_root_id;
     header_page->GetRootId(index_metadata->GetName(), index_root_id);
+    header_guard.Drop();
     index = ConstructIndex(index_metadata, buffer_pool_manager, index_root_id);
   }
+  header_guard.Drop();
   VirtualTable *table =
       new VirtualTable(schema, buffer_pool_manager, lock_manager, log_manager,
                        index, table_root_id);
@@ -103,7 +103,6 @@ int VtabConnect(sqlite3 *db, void *pAux, int argc, const char *const *argv,
   assert(sqlite3_declare_vtab(db, schema_string.c_str()) == SQLITE_OK);
 
   *ppVtab = reinterpret_cast<sqlite3_vtab *>(table);
-  buffer_pool_manager->UnpinPage(HEADER_PAGE_ID, false);
   return SQLITE_OK;
 }
 
@@ -355,6 +354,7 @@ __declspec(dllexport)
                                        const sqlite3_api_routines *pApi) {
   SQLITE_EXTENSION_INIT2(pApi);
   std::string db_file_name = "vtable.db";
+  std::string warmup_file_name = "vtable.warm";
   struct stat buffer;
   bool is_file_exist = (stat(db_file_name.c_str(), &buffer) == 0);
 
@@ -365,13 +365,22 @@ __declspec(dllexport)
   // create header page from BufferPoolManager if necessary
   if (!is_file_exist) {
     page_id_t header_page_id;
-    storage_engine_->buffer_pool_manager_->NewPage(header_page_id);
+    storage_engine_->buffer_pool_manager_->NewPageGuarded(header_page_id);
 
     assert(header_page_id == HEADER_PAGE_ID);
-    storage_engine_->buffer_pool_manager_->UnpinPage(header_page_id, true);
+  } else {
+    // bring back the pages that were hot before the restart
+    storage_engine_->buffer_pool_manager_->WarmUp(warmup_file_name);
   }
+  storage_engine_->buffer_pool_manager_->RunResidentPageDumper(
+      warmup_file_name);
 
   int rc = sqlite3_create_module(db, "vtable", &VtableModule, nullptr);
+  if (rc != SQLITE_OK)
+    return rc;
+  // statistics of the buffer pool, also usable without CREATE as "bpstats"
+  rc = sqlite3_create_module(db, "bpstats", &BufferPoolStatsModule,
+                             storage_engine_->buffer_pool_manager_);
   return rc;
 }
 
@@ -0,0 +1,99 @@
+/**
+ * arc_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer<int> arc_replacer(4);
+  typedef ARCReplacer<int> ARC;
+
+  // 1 and 2 are seen twice (T2), 3 and 4 once (T1)
+  arc_replacer.RecordAccess(1);
+  arc_replacer.RecordAccess(2);
+  arc_replacer.RecordAccess(1);
+  arc_replacer.RecordAccess(2);
+  arc_replacer.Insert(1);
+  arc_replacer.Insert(2);
+  arc_replacer.Insert(3);
+  arc_replacer.Insert(4);
+  EXPECT_EQ(4, arc_replacer.Size());
+  EXPECT_EQ(2, arc_replacer.GetListSize(ARC::T1));
+  EXPECT_EQ(2, arc_replacer.GetListSize(ARC::T2));
+  EXPECT_EQ(0, arc_replacer.GetTargetT1Size());
+
+  // T1 is above its target size, its least recent page goes to B1
+  int value;
+  arc_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(1, arc_replacer.GetListSize(ARC::B1));
+
+  // 3 comes back: T1 was too small, grow its target; 3 is now frequent
+  arc_replacer.RecordAccess(3);
+  EXPECT_EQ(1, arc_replacer.GetTargetT1Size());
+  EXPECT_EQ(0, arc_replacer.GetListSize(ARC::B1));
+  EXPECT_EQ(3, arc_replacer.GetListSize(ARC::T2));
+
+  // T1 = {4} is not above target 1, so T2 gives up its least recent page
+  arc_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(1, arc_replacer.GetListSize(ARC::B2));
+
+  // 1 comes back from B2: shrink the target of T1 again
+  arc_replacer.RecordAccess(1);
+  EXPECT_EQ(0, arc_replacer.GetTargetT1Size());
+
+  // pinned pages are skipped
+  EXPECT_EQ(true, arc_replacer.Erase(4));
+  EXPECT_EQ(false, arc_replacer.Erase(4));
+  arc_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(false, arc_replacer.Victim(value));
+  arc_replacer.Insert(3);
+  arc_replacer.Insert(4);
+  arc_replacer.Remove(3);
+  EXPECT_EQ(1, arc_replacer.Size());
+  arc_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(0, arc_replacer.Size());
+
+  // a value evicted by choice of the caller becomes a ghost as well
+  arc_replacer.Insert(5);
+  EXPECT_EQ(true, arc_replacer.Evict(5));
+  EXPECT_EQ(false, arc_replacer.Evict(5));
+  EXPECT_EQ(0, arc_replacer.Size());
+  arc_replacer.RecordAccess(5);
+  EXPECT_LT(0, arc_replacer.GetTargetT1Size());
+}
+
+TEST(ARCReplacerTest, CorrelatedReferenceTest) {
+  ARCReplacer<int> arc_replacer(4, 2);
+  typedef ARCReplacer<int> ARC;
+
+  // 1 is accessed again right away and stays in T1, 2 is accessed again
+  // after 3 and 4 and moves to T2
+  arc_replacer.RecordAccess(1);
+  arc_replacer.RecordAccess(1);
+  arc_replacer.RecordAccess(2);
+  arc_replacer.RecordAccess(3);
+  arc_replacer.RecordAccess(4);
+  arc_replacer.RecordAccess(2);
+  EXPECT_EQ(3, arc_replacer.GetListSize(ARC::T1));
+  EXPECT_EQ(1, arc_replacer.GetListSize(ARC::T2));
+
+  // a page of T2 accessed again right away stays there
+  arc_replacer.RecordAccess(2);
+  EXPECT_EQ(1, arc_replacer.GetListSize(ARC::T2));
+  for (int i = 1; i <= 4; ++i)
+    arc_replacer.Insert(i);
+  int value;
+  arc_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+}
+
+} // namespace cmudb
@@ -3,12 +3,27 @@
  */
 
 #include <cstdio>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace cmudb {
 
+// use page_id over and over, until the next use of any other page is no
+// longer correlated with the last one of that page
+static void PassCorrelationPeriod(BufferPoolManager &bpm, page_id_t page_id) {
+  for (int i = 0; i < CORRELATED_REFERENCE_PERIOD; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+  }
+}
+
 TEST(BufferPoolManagerTest, SampleTest) {
   page_id_t temp_page_id;
 
@@ -48,4 +63,908 @@ TEST(BufferPoolManagerTest, SampleTest) {
   remove("test.db");
 }
 
+TEST(BufferPoolManagerTest, PartitionTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager, nullptr, 2);
+  EXPECT_EQ(2, bpm.GetNumInstances());
+
+  // page ids alternate between the two instances of 5 frames each
+  for (int i = 0; i < 10; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, temp_page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(INVALID_PAGE_ID, temp_page_id);
+
+  // free a frame in the instance owning odd page ids only, page 10 still
+  // goes to the full instance owning even page ids
+  EXPECT_EQ(true, bpm.UnpinPage(1, true));
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  // the failed allocation above gave back page id 10
+  for (int i = 0; i < 10; i += 2) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(10, temp_page_id);
+  EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+
+  // page 0 was evicted from its instance, page 1 is still resident
+  auto page = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+  page = bpm.FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 1"));
+  EXPECT_EQ(1, bpm.GetMissCount(0));
+  EXPECT_EQ(0, bpm.GetHitCount(0));
+  EXPECT_EQ(0, bpm.GetMissCount(1));
+  EXPECT_EQ(1, bpm.GetHitCount(1));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const int num_pages = 50;
+  const int num_threads = 4;
+  page_id_t temp_page_id;
+
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK,
+                             ReplacerType::LRU_K, ReplacerType::ARC}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager bpm(10, disk_manager, nullptr, 2, replacer_type);
+    for (int i = 0; i < num_pages; ++i) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+
+    // misses write back dirty victims and read pages while other threads
+    // keep hitting and missing on the same frames
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.push_back(std::thread([&bpm, t]() {
+        char expected[PAGE_SIZE];
+        for (int i = 0; i < 500; ++i) {
+          page_id_t page_id = (i * 7 + t * 13) % num_pages;
+          auto page = bpm.FetchPage(page_id);
+          if (page == nullptr)
+            continue;
+          snprintf(expected, PAGE_SIZE, "page %d", page_id);
+          EXPECT_EQ(0, strcmp(page->GetData(), expected));
+          EXPECT_EQ(page_id, page->GetPageId());
+          EXPECT_EQ(true, bpm.UnpinPage(page_id, i % 2 == 0));
+        }
+      }));
+    }
+    for (auto &thread : threads)
+      thread.join();
+
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(BufferPoolManagerTest, ClockReplacerTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager, nullptr, 1, ReplacerType::CLOCK);
+
+  auto page_zero = bpm.NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page_zero);
+  strcpy(page_zero->GetData(), "Hello");
+  for (int i = 1; i < 10; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(true, bpm.UnpinPage(i, true));
+  }
+  // only the five unpinned pages can be replaced
+  for (int i = 10; i < 15; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_EQ(true, bpm.UnpinPage(10, false));
+  page_zero = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page_zero);
+  EXPECT_EQ(0, strcmp(page_zero->GetData(), "Hello"));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, LRUKScanResistanceTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(5, disk_manager, nullptr, 1, ReplacerType::LRU_K);
+
+  // pages 0 and 1 are hot, used again after other pages were. Every other
+  // page is touched by a scan, page 2 many times in a row, which counts as
+  // once
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  PassCorrelationPeriod(bpm, 2);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(i));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  for (int i = 3; i < 20; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  size_t misses = bpm.GetMissCount(0);
+  ASSERT_NE(nullptr, bpm.FetchPage(0));
+  ASSERT_NE(nullptr, bpm.FetchPage(1));
+  EXPECT_EQ(misses, bpm.GetMissCount(0));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, ARCReplacerTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(5, disk_manager, nullptr, 1, ReplacerType::ARC);
+  auto arc = dynamic_cast<ARCReplacer<Page *> *>(bpm.GetReplacer(0));
+  ASSERT_NE(nullptr, arc);
+
+  // pages 0 and 1 are used twice, pages 2..9 once by a scan, page 2 many
+  // times in a row, which does not promote it to T2
+  for (int i = 0; i < 10; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    if (i == 2) {
+      PassCorrelationPeriod(bpm, 2);
+      EXPECT_EQ(0, arc->GetListSize(ARCReplacer<Page *>::T2));
+      for (int j = 0; j < 2; ++j) {
+        ASSERT_NE(nullptr, bpm.FetchPage(j));
+        EXPECT_EQ(true, bpm.UnpinPage(j, false));
+      }
+    }
+  }
+  // the scan only replaced its own pages
+  size_t misses = bpm.GetMissCount(0);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(i));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  EXPECT_EQ(misses, bpm.GetMissCount(0));
+  // page 6 was evicted from T1 recently, fetching it again makes ARC grow
+  // the target size of T1
+  EXPECT_EQ(0, arc->GetTargetT1Size());
+  auto page = bpm.FetchPage(6);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 6"));
+  EXPECT_EQ(true, bpm.UnpinPage(6, false));
+  EXPECT_LT(0, arc->GetTargetT1Size());
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+
+TEST(BufferPoolManagerTest, PinnedVictimTest) {
+  page_id_t temp_page_id;
+
+  // a hit pins its frame without taking it out of the replacer; eviction
+  // has to pass over it without touching its history
+  DiskManager *disk_manager = new DiskManager("test.db");
+  {
+    BufferPoolManager bpm(3, disk_manager, nullptr, 1, ReplacerType::ARC);
+    auto arc = dynamic_cast<ARCReplacer<Page *> *>(bpm.GetReplacer(0));
+    ASSERT_NE(nullptr, arc);
+    page_id_t first;
+    ASSERT_NE(nullptr, bpm.NewPage(first));
+    EXPECT_EQ(true, bpm.UnpinPage(first, true));
+    page_id_t hot;
+    ASSERT_NE(nullptr, bpm.NewPage(hot));
+    EXPECT_EQ(true, bpm.UnpinPage(hot, true));
+    PassCorrelationPeriod(bpm, hot);
+    ASSERT_NE(nullptr, bpm.FetchPage(first));
+    EXPECT_EQ(true, bpm.UnpinPage(first, false));
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    // ARC would take hot, the least recently used page of T1
+    ASSERT_NE(nullptr, bpm.FetchPage(hot));
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(hot, false));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+    // hot never became a ghost, so its unpin is no ghost hit
+    EXPECT_EQ(0u, arc->GetTargetT1Size());
+    EXPECT_EQ(1u, arc->GetListSize(ARCReplacer<Page *>::B1));
+  }
+  {
+    BufferPoolManager bpm(2, disk_manager, nullptr, 1, ReplacerType::LRU_K);
+    page_id_t hot;
+    ASSERT_NE(nullptr, bpm.NewPage(hot));
+    EXPECT_EQ(true, bpm.UnpinPage(hot, true));
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    PassCorrelationPeriod(bpm, hot);
+    ASSERT_NE(nullptr, bpm.FetchPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+    // LRU-K would take hot, the only page with fewer than K accesses
+    ASSERT_NE(nullptr, bpm.FetchPage(hot));
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    PassCorrelationPeriod(bpm, temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(hot, false));
+    // hot kept its first access, so with this one it has K and outlives a
+    // scan
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+      EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+    }
+    size_t misses = bpm.GetMissCount(0);
+    ASSERT_NE(nullptr, bpm.FetchPage(hot));
+    EXPECT_EQ(true, bpm.UnpinPage(hot, false));
+    EXPECT_EQ(misses, bpm.GetMissCount(0));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+  bpm.RunBackgroundWriter(2, std::chrono::milliseconds(10), 0.5);
+
+  // fill the pool with dirty unpinned pages
+  for (int i = 0; i < 10; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  // above the high-water mark every dirty page gets cleaned in the next round
+  for (int i = 0; i < 200 && bpm.GetDirtyRatio(0) > 0; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(0, bpm.GetDirtyRatio(0));
+  EXPECT_LE(10, bpm.GetWriteBackCount(0));
+
+  // below the high-water mark only the eviction end is looked at, so a page
+  // that was just used stays dirty
+  auto page = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(true, bpm.UnpinPage(0, true));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(0.1, bpm.GetDirtyRatio(0));
+  bpm.StopBackgroundWriter();
+
+  // evicting clean victims writes nothing, the content survived on disk
+  for (int i = 10; i < 20; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, false));
+  }
+  for (int i = 0; i < 10; ++i) {
+    page = bpm.FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(5, disk_manager);
+
+  for (int i = 0; i < 10; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  // pages 0..4 were evicted, a resident-only fetch never reads them
+  EXPECT_EQ(nullptr, bpm.FetchResidentPage(0));
+
+  // the hint returns right away, the page shows up later
+  bpm.PrefetchPage(0);
+  Page *page = nullptr;
+  for (int i = 0; i < 200 && page == nullptr; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    page = bpm.FetchResidentPage(0);
+  }
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+  EXPECT_EQ(1, bpm.GetPrefetchCount(0));
+  // the read ahead is not a miss, the fetch after it is a hit
+  EXPECT_EQ(0, bpm.GetMissCount(0));
+
+  // resident pages are not read again
+  size_t misses = bpm.GetMissCount(0);
+  bpm.PrefetchPage(0);
+  page = bpm.FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(true, bpm.UnpinPage(0, false));
+  EXPECT_EQ(misses, bpm.GetMissCount(0));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+
+TEST(BufferPoolManagerTest, BufferRingTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(10, disk_manager);
+
+  // pages 0..4 are the hot set
+  for (int i = 0; i < 5; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  // a bulk load of 20 pages recycles its ring of 2 frames
+  auto strategy = bpm.NewAccessStrategy(2);
+  for (int i = 5; i < 25; ++i) {
+    auto page = bpm.NewPage(temp_page_id, strategy.get());
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  // and a scan of them as well
+  for (int i = 5; i < 25; ++i) {
+    auto page = bpm.FetchPage(i, strategy.get());
+    ASSERT_NE(nullptr, page);
+    char expected[PAGE_SIZE];
+    snprintf(expected, PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  // the hot set was not evicted
+  size_t misses = bpm.GetMissCount(0);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(i));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  EXPECT_EQ(misses, bpm.GetMissCount(0));
+
+  // a pinned ring frame is not recycled, the miss takes another frame
+  auto page = bpm.FetchPage(23, strategy.get());
+  ASSERT_NE(nullptr, page);
+  auto other = bpm.FetchPage(24, strategy.get());
+  ASSERT_NE(nullptr, other);
+  ASSERT_NE(nullptr, bpm.FetchPage(5, strategy.get()));
+  EXPECT_EQ(23, page->GetPageId());
+  EXPECT_EQ(24, other->GetPageId());
+  EXPECT_EQ(true, bpm.UnpinPage(5, false));
+  EXPECT_EQ(true, bpm.UnpinPage(23, false));
+  EXPECT_EQ(true, bpm.UnpinPage(24, false));
+
+  // a scan reading ahead into the default ring reads every page once. Like
+  // a table scan, it only pins its page while reading a tuple, so a hint
+  // may arrive while the page is unpinned; the ring keeps room for it
+  for (int i = 25; i < 45; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id, strategy.get()));
+    EXPECT_EQ(true, bpm.UnpinPage(temp_page_id, true));
+  }
+  auto scan = bpm.NewAccessStrategy();
+  auto read_ahead = [&bpm, &scan](page_id_t page_id) {
+    std::promise<void> read;
+    bpm.PrefetchPage(page_id, scan, [&read](Page *) { read.set_value(); });
+    EXPECT_EQ(std::future_status::ready,
+              read.get_future().wait_for(std::chrono::seconds(5)));
+  };
+  size_t reads = bpm.GetMissCount(0) + bpm.GetPrefetchCount(0);
+  for (int i = 25; i < 43; ++i) {
+    ASSERT_NE(nullptr, bpm.FetchPage(i, scan.get()));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+    for (int j = i == 25 ? 1 : TABLE_READ_AHEAD_PAGES;
+         j <= TABLE_READ_AHEAD_PAGES && i + j < 43; ++j)
+      read_ahead(i + j);
+    ASSERT_NE(nullptr, bpm.FetchPage(i, scan.get()));
+    EXPECT_EQ(true, bpm.UnpinPage(i, false));
+  }
+  EXPECT_EQ(18u, bpm.GetMissCount(0) + bpm.GetPrefetchCount(0) - reads);
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, PageSizeTest) {
+  page_id_t temp_page_id;
+  remove("test.db");
+
+  // a new database takes its page size and pool size from the options
+  DiskManager *disk_manager = new DiskManager("test.db", 4096, 8);
+  EXPECT_EQ(4096u, disk_manager->GetPageSize());
+  BufferPoolManager *bpm =
+      new BufferPoolManager(disk_manager->GetPoolSize(), disk_manager);
+  EXPECT_EQ(4096u, bpm->GetPageSize());
+  for (int i = 0; i < 2; ++i) {
+    auto page = bpm->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(4096u, page->GetPageSize());
+    // fill the whole page but its checksum, the tail must survive the
+    // round trip
+    memset(page->GetData(), 'a' + i, page->GetDataSize());
+    bpm->UnpinPage(temp_page_id, true);
+    bpm->FlushPage(temp_page_id);
+  }
+  delete bpm;
+  delete disk_manager;
+
+  // reopening keeps them, the page size asked for is ignored
+  disk_manager = new DiskManager("test.db", 1024);
+  EXPECT_EQ(4096u, disk_manager->GetPageSize());
+  EXPECT_EQ(8u, disk_manager->GetPoolSize());
+  // log buffers hold one page more than the pool
+  EXPECT_EQ(9u * 4096, LogManager(disk_manager).GetLogBufferSize());
+  bpm = new BufferPoolManager(disk_manager->GetPoolSize(), disk_manager);
+  for (int i = 0; i < 2; ++i) {
+    auto page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ('a' + i, page->GetData()[0]);
+    EXPECT_EQ('a' + i, page->GetData()[4096 - PAGE_CHECKSUM_SIZE - 1]);
+    bpm->UnpinPage(i, false);
+  }
+  delete bpm;
+  delete disk_manager;
+
+  // a new pool size replaces the stored one
+  disk_manager = new DiskManager("test.db", 0, 16);
+  delete disk_manager;
+  disk_manager = new DiskManager("test.db");
+  EXPECT_EQ(16u, disk_manager->GetPoolSize());
+  delete disk_manager;
+
+  EXPECT_THROW(DiskManager("bad.db", 1000), Exception);
+
+  remove("test.db");
+  remove("test.log");
+  remove("bad.db");
+  remove("bad.log");
+}
+
+// huge pages neither in use nor reserved by a mapping, from /proc/meminfo
+static size_t FreeHugePages() {
+  FILE *meminfo = fopen("/proc/meminfo", "r");
+  char line[128];
+  size_t free_pages = 0, reserved = 0;
+  while (meminfo != nullptr && fgets(line, sizeof(line), meminfo) != nullptr) {
+    sscanf(line, "HugePages_Free: %zu", &free_pages);
+    sscanf(line, "HugePages_Rsvd: %zu", &reserved);
+  }
+  if (meminfo != nullptr)
+    fclose(meminfo);
+  return free_pages - reserved;
+}
+
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  page_id_t temp_page_id;
+
+  // huge pages fall back to normal ones when none are reserved
+  BUFFER_POOL_HUGE_PAGES = true;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(16, disk_manager);
+  BUFFER_POOL_HUGE_PAGES = false;
+
+  std::vector<Page *> pages;
+  for (int i = 0; i < 16; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    // descriptors are cache line aligned, the data page aligned and packed
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(page) % CACHE_LINE_SIZE);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(page->GetData()) % PAGE_SIZE);
+    EXPECT_NE(page->GetData(), reinterpret_cast<char *>(page));
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    pages.push_back(page);
+  }
+  for (int i = 0; i < 16; ++i) {
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    EXPECT_EQ(0, strcmp(expected, pages[i]->GetData()));
+    bpm.UnpinPage(i, true);
+  }
+
+  // huge pages are mapped for the frames committed only, and go back to
+  // the system when released
+  FrameArena arena(4 * HUGE_PAGE_SIZE, true, HUGE_PAGE_SIZE);
+  if (arena.IsHugeTLB()) {
+    size_t free_pages = FreeHugePages();
+    EXPECT_TRUE(arena.Commit(HUGE_PAGE_SIZE, 2 * HUGE_PAGE_SIZE));
+    EXPECT_EQ(free_pages - 2, FreeHugePages());
+    arena.GetData()[2 * HUGE_PAGE_SIZE] = 'x';
+    arena.Release(HUGE_PAGE_SIZE, 2 * HUGE_PAGE_SIZE);
+    EXPECT_EQ(free_pages, FreeHugePages());
+    EXPECT_TRUE(arena.Commit(2 * HUGE_PAGE_SIZE, 1));
+    EXPECT_EQ(0, arena.GetData()[2 * HUGE_PAGE_SIZE]);
+  }
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, StatsTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(2, disk_manager);
+
+  // two new pages fill the pool, a third evicts page 0 and writes it back
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    bpm.UnpinPage(temp_page_id, true);
+  }
+  EXPECT_NE(nullptr, bpm.FetchPage(2)); // hit
+  EXPECT_NE(nullptr, bpm.FetchPage(0)); // miss, evicts dirty page 1
+  EXPECT_TRUE(bpm.FlushPage(0));
+
+  BufferPoolStats stats = bpm.GetStats();
+  EXPECT_EQ(1u, stats.Get(BufferPoolEvent::HIT));
+  EXPECT_EQ(1u, stats.Get(BufferPoolEvent::MISS));
+  EXPECT_DOUBLE_EQ(0.5, stats.GetHitRatio());
+  EXPECT_EQ(2u, stats.Get(BufferPoolEvent::EVICTION));
+  EXPECT_EQ(2u, stats.Get(BufferPoolEvent::DIRTY_EVICTION));
+  EXPECT_EQ(1u, stats.Get(BufferPoolEvent::FLUSH));
+  EXPECT_EQ(1u, stats.read_latency_.count_);
+  EXPECT_EQ(3u, stats.write_latency_.count_);
+  EXPECT_GE(stats.write_latency_.GetPercentile(1.0),
+            stats.write_latency_.GetMean());
+
+  // a reader blocked by a writer records its wait
+  {
+    auto writer = bpm.FetchPageWrite(0);
+    std::thread reader([&bpm] { bpm.FetchPageRead(0); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    writer.Drop();
+    reader.join();
+  }
+  stats = bpm.GetStats();
+  EXPECT_EQ(1u, stats.page_latch_wait_.count_);
+  EXPECT_GE(stats.page_latch_wait_.sum_, 1000000u);
+  bpm.UnpinPage(0, false);
+  bpm.UnpinPage(2, false);
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, ResizeTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(4, disk_manager, nullptr, 2);
+  EXPECT_FALSE(bpm.Resize(1));
+  EXPECT_FALSE(bpm.Resize(4 * BUFFER_POOL_MAX_GROWTH + 1));
+
+  // growing gives room for more pinned pages at once
+  std::vector<Page *> pages;
+  for (int i = 0; i < 4; ++i) {
+    pages.push_back(bpm.NewPage(temp_page_id));
+    ASSERT_NE(nullptr, pages.back());
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+  EXPECT_TRUE(bpm.Resize(8));
+  EXPECT_EQ(8u, bpm.GetPoolSize());
+  for (int i = 4; i < 8; ++i) {
+    pages.push_back(bpm.NewPage(temp_page_id));
+    ASSERT_NE(nullptr, pages.back());
+    EXPECT_EQ(i, temp_page_id);
+  }
+  for (int i = 0; i < 8; ++i)
+    snprintf(pages[i]->GetData(), PAGE_SIZE, "page %d",
+             pages[i]->GetPageId());
+
+  // shrinking evicts the unpinned frames now and the pinned ones later
+  for (int i = 0; i < 6; ++i)
+    bpm.UnpinPage(pages[i]->GetPageId(), true);
+  // instance 0 keeps two dirty pages pinned in its one frame left
+  ASSERT_EQ(pages[4], bpm.FetchPage(4));
+  ASSERT_EQ(pages[6], bpm.FetchPage(6));
+  bpm.UnpinPage(6, true);
+  EXPECT_TRUE(bpm.Resize(2));
+  EXPECT_EQ(1u, bpm.GetPoolSize(0));
+  EXPECT_EQ(1u, bpm.GetPoolSize(1));
+  EXPECT_LT(0, bpm.GetDirtyRatio(0));
+  EXPECT_GE(1, bpm.GetDirtyRatio(0));
+  page_id_t pinned[3] = {4, pages[6]->GetPageId(), pages[7]->GetPageId()};
+  for (page_id_t page_id : pinned)
+    bpm.UnpinPage(page_id, true);
+  for (int i = 0; i < 100 && bpm.IsResizing(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(bpm.IsResizing());
+
+  // every page was written back and comes back one at a time
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", page_id);
+    auto page = bpm.FetchPageRead(page_id);
+    ASSERT_TRUE(page.IsValid());
+    EXPECT_EQ(0, strcmp(expected, page.GetData()));
+  }
+  auto page0 = bpm.FetchPageRead(0);
+  auto page1 = bpm.FetchPageRead(1);
+  EXPECT_FALSE(bpm.FetchPageRead(2).IsValid());
+  page0.Drop();
+  page1.Drop();
+
+  // and grows again into the frames it gave up
+  EXPECT_TRUE(bpm.Resize(16));
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_NE(nullptr, bpm.NewPage(temp_page_id));
+  }
+  EXPECT_EQ(nullptr, bpm.NewPage(temp_page_id));
+
+  // a page deleted from a frame about to retire does not free the frame
+  BufferPoolManager one(2, disk_manager, nullptr, 1);
+  ASSERT_NE(nullptr, one.NewPage(temp_page_id));
+  ASSERT_NE(nullptr, one.NewPage(temp_page_id));
+  EXPECT_TRUE(one.Resize(1));
+  one.UnpinPage(temp_page_id, false);
+  EXPECT_TRUE(one.DeletePage(temp_page_id));
+  EXPECT_EQ(nullptr, one.NewPage(temp_page_id));
+
+  // the CLOCK replacer covers the live frames only, and grows with them
+  BufferPoolManager clock(2, disk_manager, nullptr, 1, ReplacerType::CLOCK);
+  EXPECT_TRUE(clock.Resize(4));
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_NE(nullptr, clock.NewPage(temp_page_id));
+    clock.UnpinPage(temp_page_id, false);
+  }
+  for (int i = 0; i < 4; ++i)
+    EXPECT_NE(nullptr, clock.NewPage(temp_page_id));
+  EXPECT_EQ(nullptr, clock.NewPage(temp_page_id));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, WarmUpTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(4, disk_manager);
+  for (int i = 0; i < 8; ++i) {
+    auto page = bpm->NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    bpm->UnpinPage(temp_page_id, true);
+    bpm->FlushPage(temp_page_id);
+  }
+  // pages 4 to 7 are resident, 6 pinned and 5 used last
+  EXPECT_NE(nullptr, bpm->FetchPage(6));
+  EXPECT_NE(nullptr, bpm->FetchPage(5));
+  bpm->UnpinPage(5, false);
+  EXPECT_FALSE(bpm->WarmUp("test.warm"));
+  bpm->RunResidentPageDumper("test.warm");
+  bpm->StopResidentPageDumper();
+  bpm->UnpinPage(6, false);
+  delete bpm;
+
+  // a smaller pool gets the hottest pages back without a miss
+  bpm = new BufferPoolManager(2, disk_manager);
+  EXPECT_TRUE(bpm->WarmUp("test.warm"));
+  for (int i = 0; i < 100 && bpm->IsWarmingUp(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_FALSE(bpm->IsWarmingUp());
+  for (page_id_t page_id : {5, 6}) {
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", page_id);
+    auto page = bpm->FetchResidentPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(expected, page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_EQ(0u, bpm->GetMissCount(0));
+  EXPECT_EQ(2u, bpm->GetStats().Get(BufferPoolEvent::WARM_UP));
+  EXPECT_EQ(0u, bpm->GetPrefetchCount(0));
+  EXPECT_EQ(nullptr, bpm->FetchResidentPage(7));
+  delete bpm;
+
+  // warm-up may bring back a page deleted meanwhile; the next page created
+  // there takes over its frame instead of being mapped twice
+  bpm = new BufferPoolManager(2, disk_manager);
+  EXPECT_TRUE(bpm->DeletePage(5));
+  EXPECT_TRUE(bpm->WarmUp("test.warm"));
+  for (int i = 0; i < 100 && bpm->IsWarmingUp(); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  auto page = bpm->NewPage(temp_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(5, temp_page_id);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(0u, bpm->GetStats().Get(BufferPoolEvent::EVICTION));
+  snprintf(page->GetData(), PAGE_SIZE, "new page");
+  bpm->UnpinPage(5, true);
+  page = bpm->FetchPage(5);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp("new page", page->GetData()));
+  bpm->UnpinPage(5, false);
+  delete bpm;
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.warm");
+}
+
+TEST(BufferPoolManagerTest, FlushDirtyPagesTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(8, disk_manager, nullptr, 2);
+  for (int i = 0; i < 8; ++i) {
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", temp_page_id);
+    bpm.UnpinPage(temp_page_id, temp_page_id != 5);
+  }
+  // a pinned page is written all the same
+  ASSERT_NE(nullptr, bpm.FetchPage(3));
+  // the page ids are spread over both instances, written in one run
+  EXPECT_EQ(7u, bpm.FlushAllPages());
+  EXPECT_EQ(7u, bpm.GetStats().Get(BufferPoolEvent::FLUSH));
+  EXPECT_EQ(0u, bpm.FlushDirtyPages());
+  EXPECT_EQ(2, bpm.FetchPage(3)->GetPinCount());
+  bpm.UnpinPage(3, false);
+  bpm.UnpinPage(3, true);
+
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", page_id);
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ(page_id == 5, strcmp(expected, data) != 0);
+  }
+  // a modification after the flush makes the page dirty again
+  EXPECT_EQ(1u, bpm.FlushDirtyPages());
+
+  // a flush of a dirty pool only pins the run it writes, so misses still
+  // find a victim while it waits for a page latch
+  BufferPoolManager dirty(4, disk_manager);
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    ASSERT_NE(nullptr, dirty.FetchPage(page_id));
+    dirty.UnpinPage(page_id, true);
+  }
+  auto page = dirty.FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  page->WLatch();
+  auto flushed = std::async(std::launch::async,
+                            [&dirty] { return dirty.FlushAllPages(); });
+  // page 0 is written alone, the flush then waits for page 1
+  for (int i = 0; i < 200 && dirty.GetStats().Get(BufferPoolEvent::FLUSH) < 2;
+       ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(2u, dirty.GetStats().Get(BufferPoolEvent::FLUSH));
+  ASSERT_NE(nullptr, dirty.FetchPage(4));
+  dirty.UnpinPage(4, false);
+  page->WUnlatch();
+  dirty.UnpinPage(1, false);
+  EXPECT_LE(2u, flushed.get());
+  EXPECT_EQ(0, dirty.GetDirtyRatio(0));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BufferPoolManagerTest, LogAwareEvictionTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  LogManager *log_manager = new LogManager(disk_manager);
+  ENABLE_LOGGING = true;
+  log_manager->SetPersistentLSN(5);
+  {
+    BufferPoolManager bpm(3, disk_manager, log_manager);
+    // in order of eviction: page 0 needs the log flushed, page 1 does not,
+    // page 2 is clean
+    for (lsn_t lsn : {10, 5, 0}) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      page->SetLSN(lsn);
+      bpm.UnpinPage(temp_page_id, lsn != 0);
+    }
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(0u, bpm.GetStats().Get(BufferPoolEvent::DIRTY_EVICTION));
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(1u, bpm.GetStats().Get(BufferPoolEvent::DIRTY_EVICTION));
+    EXPECT_EQ(0u, bpm.GetLogForceCount(0));
+
+    // the last resort waits for the log
+    std::thread flusher([log_manager] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      log_manager->SetPersistentLSN(10);
+    });
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    flusher.join();
+    EXPECT_EQ(2u, bpm.GetStats().Get(BufferPoolEvent::DIRTY_EVICTION));
+    EXPECT_EQ(1u, bpm.GetLogForceCount(0));
+  }
+  {
+    // the victim taken instead of the replacer's choice leaves a ghost
+    BufferPoolManager bpm(3, disk_manager, log_manager, 1, ReplacerType::ARC);
+    auto arc = dynamic_cast<ARCReplacer<Page *> *>(bpm.GetReplacer(0));
+    ASSERT_NE(nullptr, arc);
+    // a frequent page in T2 leaves room for ghosts of T1
+    page_id_t frequent;
+    ASSERT_NE(nullptr, bpm.NewPage(frequent));
+    bpm.UnpinPage(frequent, false);
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    bpm.UnpinPage(temp_page_id, false);
+    PassCorrelationPeriod(bpm, temp_page_id);
+    EXPECT_EQ(true, bpm.DeletePage(temp_page_id));
+    ASSERT_NE(nullptr, bpm.FetchPage(frequent));
+    bpm.UnpinPage(frequent, false);
+    for (lsn_t lsn : {20, 0}) {
+      auto page = bpm.NewPage(temp_page_id);
+      ASSERT_NE(nullptr, page);
+      page->SetLSN(lsn);
+      bpm.UnpinPage(temp_page_id, lsn != 0);
+    }
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(0u, bpm.GetStats().Get(BufferPoolEvent::DIRTY_EVICTION));
+    EXPECT_EQ(1u, arc->GetListSize(ARCReplacer<Page *>::B1));
+  }
+  {
+    // with no flush thread the log force times out, and the page is not
+    // written ahead of its log records but kept dirty
+    BufferPoolManager bpm(1, disk_manager, log_manager);
+    auto page = bpm.NewPage(temp_page_id);
+    ASSERT_NE(nullptr, page);
+    page->SetLSN(50);
+    strcpy(page->GetData() + 8, "logged");
+    bpm.UnpinPage(temp_page_id, true);
+    page_id_t other_page_id;
+    EXPECT_EQ(nullptr, bpm.NewPage(other_page_id));
+    EXPECT_FALSE(bpm.FlushPage(temp_page_id));
+    EXPECT_EQ(0u, bpm.FlushDirtyPages());
+    EXPECT_EQ(0u, bpm.GetLogForceCount(0));
+    EXPECT_EQ(1, bpm.GetDirtyRatio(0));
+    char data[PAGE_SIZE];
+    disk_manager->ReadPage(temp_page_id, data);
+    EXPECT_NE(0, strcmp("logged", data + 8));
+    // once the log is on disk the page goes out
+    log_manager->SetPersistentLSN(50);
+    EXPECT_EQ(1u, bpm.FlushDirtyPages());
+    disk_manager->ReadPage(temp_page_id, data);
+    EXPECT_EQ(0, strcmp("logged", data + 8));
+  }
+  ENABLE_LOGGING = false;
+
+  delete log_manager;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace cmudb
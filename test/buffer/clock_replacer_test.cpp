@@ -0,0 +1,77 @@
+/**
+ * clock_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/clock_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(ClockReplacerTest, SampleTest) {
+  ClockReplacer<int> clock_replacer(7);
+
+  // push element into replacer
+  clock_replacer.Insert(1);
+  clock_replacer.Insert(2);
+  clock_replacer.Insert(3);
+  clock_replacer.Insert(4);
+  clock_replacer.Insert(5);
+  clock_replacer.Insert(6);
+  clock_replacer.Insert(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // every frame is referenced, the first sweep only clears reference bits
+  int value;
+  clock_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+
+  // a referenced frame gets a second chance
+  clock_replacer.Insert(3);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+
+  // remove element from replacer
+  EXPECT_EQ(false, clock_replacer.Erase(4));
+  EXPECT_EQ(true, clock_replacer.Erase(6));
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // pop element from replacer after removal
+  clock_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  clock_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, CapacityTest) {
+  ClockReplacer<int> clock_replacer(2);
+  clock_replacer.Insert(1);
+
+  // the hand reaches the frames added by growing
+  clock_replacer.SetCapacity(4);
+  clock_replacer.Insert(3);
+  EXPECT_EQ(2, clock_replacer.Size());
+  int value;
+  EXPECT_EQ(true, clock_replacer.Victim(value));
+  EXPECT_EQ(1, value);
+  EXPECT_EQ(true, clock_replacer.Victim(value));
+  EXPECT_EQ(3, value);
+
+  // and no longer sweeps the ones above a smaller capacity, which can still
+  // be erased
+  clock_replacer.Insert(0);
+  clock_replacer.Insert(3);
+  clock_replacer.SetCapacity(2);
+  EXPECT_EQ(true, clock_replacer.Victim(value));
+  EXPECT_EQ(0, value);
+  EXPECT_EQ(false, clock_replacer.Victim(value));
+  EXPECT_EQ(true, clock_replacer.Erase(3));
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+} // namespace cmudb
@@ -0,0 +1,87 @@
+/**
+ * lru_k_replacer_test.cpp
+ */
+
+#include <cstdio>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer<int> lru_k_replacer(2);
+
+  // 1 and 2 are accessed twice, 3..6 only once (e.g. by a scan)
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.Insert(1);
+  lru_k_replacer.Insert(2);
+  lru_k_replacer.Insert(3);
+  lru_k_replacer.Insert(4);
+  lru_k_replacer.Insert(5);
+  lru_k_replacer.Insert(6);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // values with less than k accesses go first, oldest first
+  int value;
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(4, value);
+
+  // pinning keeps history: a second access of 5 moves it behind 6
+  EXPECT_EQ(true, lru_k_replacer.Erase(5));
+  EXPECT_EQ(false, lru_k_replacer.Erase(5));
+  lru_k_replacer.RecordAccess(5);
+  lru_k_replacer.Insert(5);
+  EXPECT_EQ(4, lru_k_replacer.Size());
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(6, value);
+
+  // with k accesses each, the oldest second most recent access goes first
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(5, value);
+  EXPECT_EQ(false, lru_k_replacer.Victim(value));
+
+  // a removed value starts over without history
+  lru_k_replacer.RecordAccess(7);
+  lru_k_replacer.RecordAccess(7);
+  lru_k_replacer.Remove(7);
+  lru_k_replacer.Insert(7);
+  lru_k_replacer.RecordAccess(8);
+  lru_k_replacer.RecordAccess(8);
+  lru_k_replacer.Insert(8);
+  lru_k_replacer.Victim(value);
+  EXPECT_EQ(7, value);
+  EXPECT_EQ(1, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer<int> lru_k_replacer(2, 2);
+
+  // 1 is accessed again right away, which counts as one access; 2 is
+  // accessed again after 3 and 4
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(3);
+  lru_k_replacer.RecordAccess(4);
+  lru_k_replacer.RecordAccess(2);
+  for (int i = 1; i <= 4; ++i)
+    lru_k_replacer.Insert(i);
+
+  int value;
+  for (int expected : {1, 3, 4, 2}) {
+    EXPECT_EQ(true, lru_k_replacer.Victim(value));
+    EXPECT_EQ(expected, value);
+  }
+}
+
+} // namespace cmudb
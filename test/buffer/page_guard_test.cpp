@@ -0,0 +1,80 @@
+/**
+ * page_guard_test.cpp
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(PageGuardTest, SampleTest) {
+  page_id_t temp_page_id;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager bpm(2, disk_manager);
+
+  {
+    auto guard = bpm.NewPageGuarded(temp_page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(0, temp_page_id);
+    strcpy(guard.GetDataMut(), "Hello");
+    EXPECT_EQ(1, guard.GetPage()->GetPinCount());
+  }
+  {
+    // the pin was released, readers share the page
+    auto guard1 = bpm.FetchPageRead(0);
+    auto guard2 = bpm.FetchPageRead(0);
+    ASSERT_TRUE(guard1.IsValid());
+    EXPECT_EQ(2, guard1.GetPage()->GetPinCount());
+    EXPECT_EQ(0, strcmp(guard2.GetData(), "Hello"));
+    guard2.Drop();
+    EXPECT_EQ(1, guard1.GetPage()->GetPinCount());
+
+    // moving hands the pin over without releasing it
+    ReadPageGuard guard3(std::move(guard1));
+    EXPECT_FALSE(guard1.IsValid());
+    EXPECT_EQ(1, guard3.GetPage()->GetPinCount());
+  }
+
+  // the dirty page survives eviction, the clean one is just dropped
+  EXPECT_TRUE(bpm.NewPageGuarded(temp_page_id).IsValid());
+  EXPECT_TRUE(bpm.NewPageGuarded(temp_page_id).IsValid());
+  {
+    auto guard = bpm.FetchPageWrite(0);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+    // a guard on a full pool is not valid
+    page_id_t other_page_id;
+    auto other = bpm.NewPageGuarded(other_page_id);
+    ASSERT_TRUE(other.IsValid());
+    EXPECT_FALSE(bpm.NewPageGuarded(temp_page_id).IsValid());
+    EXPECT_FALSE(bpm.FetchPageRead(1).IsValid());
+
+    // assigning another guard releases the current page
+    other = WritePageGuard();
+    EXPECT_TRUE(bpm.FetchPageRead(1).IsValid());
+  }
+  {
+    // As only looks at the page, writes go through AsMut and make it dirty
+    auto guard = bpm.FetchPageWrite(0);
+    static_assert(std::is_same<const Page *,
+                               decltype(guard.As<Page>())>::value,
+                  "As gives a read-only view");
+    EXPECT_EQ(0, strcmp(guard.As<Page>()->GetData(), "Hello"));
+    strcpy(guard.AsMut<Page>()->GetData(), "World");
+  }
+  EXPECT_TRUE(bpm.FetchPageRead(1).IsValid());
+  EXPECT_TRUE(bpm.FetchPageRead(2).IsValid());
+  EXPECT_EQ(0, strcmp(bpm.FetchPageRead(0).GetData(), "World"));
+
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
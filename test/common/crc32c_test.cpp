@@ -0,0 +1,91 @@
+/**
+ * crc32c_test.cpp
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/crc32c.h"
+#include "disk/disk_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(Crc32cTest, SampleTest) {
+  // check values of RFC 3720 (iSCSI)
+  EXPECT_EQ(0u, Crc32c(nullptr, 0));
+  EXPECT_EQ(0xe3069283u, Crc32c("123456789", 9));
+  std::vector<char> data(32, 0);
+  EXPECT_EQ(0x8a9136aau, Crc32c(data.data(), data.size()));
+  data.assign(32, '\xff');
+  EXPECT_EQ(0x62a8ab43u, Crc32c(data.data(), data.size()));
+
+  // every length and alignment gives the same with both implementations
+  std::mt19937 rng(15445);
+  data.resize(2048);
+  for (auto &c : data)
+    c = static_cast<char>(rng());
+  for (size_t start = 0; start < 8; ++start) {
+    for (size_t size = 0; start + size <= data.size(); ++size) {
+      EXPECT_EQ(Crc32cTable(&data[start], size), Crc32c(&data[start], size));
+    }
+  }
+}
+
+template <typename Function> static double NanosPerCall(Function function) {
+  const int rounds = 20000;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < rounds; ++i)
+    function(i);
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / rounds;
+}
+
+// checksum cost per page, against the cost of reading a page (from the OS
+// page cache, the cheapest read there is)
+TEST(Crc32cTest, BenchmarkTest) {
+  const size_t page_size = 4096;
+  std::vector<char> page(page_size);
+  for (size_t i = 0; i < page_size; ++i)
+    page[i] = static_cast<char>(i * 7);
+  volatile uint32_t sink = 0;
+  double table = NanosPerCall([&](int) {
+    sink = sink + Crc32cTable(page.data(), page_size);
+  });
+  std::cout << "table:    " << table << " ns/page" << std::endl;
+#ifdef CRC32C_SSE42
+  double hardware = NanosPerCall([&](int) {
+    sink = sink + Crc32cHardware(page.data(), page_size);
+  });
+  std::cout << "hardware: " << hardware << " ns/page" << std::endl;
+  EXPECT_EQ(Crc32cTable(page.data(), page_size),
+            Crc32cHardware(page.data(), page_size));
+#endif
+
+  remove("test.db");
+  const int num_pages = 64;
+  DiskManager *disk_manager = new DiskManager("test.db", page_size);
+  EXPECT_TRUE(disk_manager->HasChecksums());
+  for (int i = 0; i < num_pages; ++i)
+    disk_manager->WritePage(i, page.data());
+  bool ok = true;
+  double verified = NanosPerCall(
+      [&](int i) { ok &= disk_manager->ReadPage(i % num_pages, page.data()); });
+  disk_manager->SetVerifyChecksums(false);
+  double unverified = NanosPerCall(
+      [&](int i) { disk_manager->ReadPage(i % num_pages, page.data()); });
+  std::cout << "read:     " << unverified << " ns/page, verified "
+            << verified << " ns/page" << std::endl;
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(0u, disk_manager->GetChecksumFailures());
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
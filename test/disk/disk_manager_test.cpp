@@ -0,0 +1,510 @@
+/**
+ * disk_manager_test.cpp
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <future>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "disk/disk_manager.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+// write "page <page id>" to count new pages of bpm and flush them. Return
+// the number of pages flushed
+static size_t WriteNumberedPages(BufferPoolManager *bpm, int count) {
+  page_id_t temp_page_id;
+  for (int i = 0; i < count; ++i) {
+    Page *page = bpm->NewPage(temp_page_id);
+    EXPECT_NE(nullptr, page);
+    if (page == nullptr)
+      return 0;
+    snprintf(page->GetData(), page->GetDataSize(), "page %d", temp_page_id);
+    bpm->UnpinPage(temp_page_id, true);
+  }
+  return bpm->FlushAllPages();
+}
+
+// whether data holds what WriteNumberedPages wrote to page_id
+static bool IsNumberedPage(page_id_t page_id, const char *data) {
+  char expected[32];
+  snprintf(expected, sizeof(expected), "page %d", page_id);
+  return strcmp(expected, data) == 0;
+}
+
+TEST(DiskManagerTest, ConcurrentDiskIOTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // threads interleave their pages, with no file cursor to share
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([disk_manager, t] {
+      char data[PAGE_SIZE] = {0};
+      char read[PAGE_SIZE];
+      for (page_id_t page_id = t; page_id < 64; page_id += 4) {
+        snprintf(data, PAGE_SIZE, "page %d", page_id);
+        disk_manager->WritePage(page_id, data);
+        disk_manager->ReadPage(page_id, read);
+        EXPECT_EQ(0, strcmp(data, read));
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  delete disk_manager;
+
+  // the file size is found again on reopen
+  disk_manager = new DiskManager("test.db");
+  char data[2 * PAGE_SIZE];
+  EXPECT_EQ(1u, disk_manager->ReadPages(63, 2, data));
+  EXPECT_TRUE(IsNumberedPage(63, data));
+  EXPECT_EQ(0, data[PAGE_SIZE]);
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, AsyncIOTest) {
+  // io_uring (if the kernel allows it) and the thread pool behave the same
+  for (bool use_io_uring : {true, false}) {
+    int fd = open("test.db", O_RDWR | O_CREAT | O_TRUNC, 0644);
+    ASSERT_LE(0, fd);
+    AsyncIO *async_io = AsyncIO::Create(8, use_io_uring);
+    if (!use_io_uring) {
+      EXPECT_FALSE(async_io->IsIOUring());
+    }
+
+    // more I/Os than the queue depth, submitters wait for room
+    std::vector<std::string> blocks;
+    for (int i = 0; i < 32; ++i)
+      blocks.push_back(std::string(PAGE_SIZE, 'a' + i % 26));
+    std::atomic<int> written(0);
+    for (int i = 0; i < 32; ++i)
+      async_io->Write(fd, blocks[i].data(), PAGE_SIZE, i * PAGE_SIZE,
+                      [&written](ssize_t rc) {
+                        if (rc == PAGE_SIZE)
+                          written++;
+                      });
+    std::vector<std::string> reads(33, std::string(PAGE_SIZE, 0));
+    std::vector<std::promise<ssize_t>> results(33);
+    delete async_io; // waits for the writes
+    EXPECT_EQ(32, written);
+
+    async_io = AsyncIO::Create(8, use_io_uring);
+    for (int i = 0; i < 33; ++i)
+      async_io->Read(fd, &reads[i][0], PAGE_SIZE, i * PAGE_SIZE,
+                     [&results, i](ssize_t rc) { results[i].set_value(rc); });
+    for (int i = 0; i < 32; ++i) {
+      EXPECT_EQ(PAGE_SIZE, results[i].get_future().get());
+      EXPECT_EQ(blocks[i], reads[i]);
+    }
+    // past the end of the file
+    EXPECT_EQ(0, results[32].get_future().get());
+    delete async_io;
+    close(fd);
+    remove("test.db");
+  }
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  char data[PAGE_SIZE];
+  memset(data, 'x', PAGE_SIZE);
+  std::promise<bool> done;
+  disk_manager->ReadPageAsync(3, data,
+                              [&done](bool ok) { done.set_value(ok); });
+  EXPECT_TRUE(done.get_future().get());
+  EXPECT_EQ(0, data[PAGE_SIZE - 1]);
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, DirectIOTest) {
+  // pages smaller than the direct I/O alignment stay in the page cache
+  DiskManager *disk_manager = new DiskManager("test.db", 512, 0, true);
+  EXPECT_FALSE(disk_manager->IsDirectIO());
+  delete disk_manager;
+  remove("test.db");
+
+  // with pages of 4KB it depends on the file system, data is the same
+  disk_manager = new DiskManager("test.db", 4096, 0, true);
+  {
+    BufferPoolManager bpm(4, disk_manager);
+    EXPECT_EQ(4u, WriteNumberedPages(&bpm, 8));
+    for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+      auto page = bpm.FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_TRUE(IsNumberedPage(page_id, page->GetData()));
+      bpm.UnpinPage(page_id, false);
+    }
+  }
+  // buffers that are not aligned are copied
+  std::vector<char> data(4096 + 1);
+  disk_manager->ReadPage(7, &data[1]);
+  EXPECT_TRUE(IsNumberedPage(7, &data[1]));
+  strcpy(&data[1], "moved");
+  disk_manager->WritePage(8, &data[1]);
+  delete disk_manager;
+
+  disk_manager = new DiskManager("test.db", 0, 0, true);
+  EXPECT_EQ(4096u, disk_manager->GetPageSize());
+  disk_manager->ReadPage(8, &data[1]);
+  EXPECT_EQ(0, strcmp("moved", &data[1]));
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, PageAllocationTest) {
+  remove("test.db");
+  // pages of 512 bytes have a bitmap page every 4096 pages
+  DiskManager *disk_manager = new DiskManager("test.db", 512);
+  for (page_id_t page_id = 0; page_id < 4100; ++page_id)
+    EXPECT_EQ(page_id, disk_manager->AllocatePage());
+  // runs of pages across a bitmap page
+  std::vector<std::vector<char>> data(4, std::vector<char>(512));
+  std::vector<const char *> pages;
+  for (int i = 0; i < 4; ++i) {
+    snprintf(data[i].data(), 512, "page %d", 4094 + i);
+    pages.push_back(data[i].data());
+  }
+  disk_manager->WritePages(4094, pages);
+  std::vector<char> read(4 * 512);
+  EXPECT_EQ(4u, disk_manager->ReadPages(4094, 4, read.data()));
+  for (int i = 0; i < 4; ++i)
+    EXPECT_TRUE(IsNumberedPage(4094 + i, &read[i * 512]));
+
+  // deleted pages are reused, lowest first
+  {
+    BufferPoolManager bpm(4, disk_manager);
+    EXPECT_TRUE(bpm.DeletePage(20));
+    EXPECT_TRUE(bpm.DeletePage(10));
+    page_id_t temp_page_id;
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(10, temp_page_id);
+    bpm.UnpinPage(temp_page_id, true);
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(20, temp_page_id);
+    bpm.UnpinPage(temp_page_id, true);
+    ASSERT_NE(nullptr, bpm.NewPage(temp_page_id));
+    EXPECT_EQ(4100, temp_page_id);
+    bpm.UnpinPage(temp_page_id, true);
+  }
+
+  // long runs of free pages are punched out of the file
+  std::vector<char> page(512, 'x');
+  for (page_id_t page_id = 100; page_id < 164; ++page_id)
+    disk_manager->WritePage(page_id, page.data());
+  disk_manager->SyncPages();
+  struct stat before, after;
+  ASSERT_EQ(0, stat("test.db", &before));
+  for (page_id_t page_id = 100; page_id < 164; ++page_id)
+    disk_manager->DeallocatePage(page_id);
+  ASSERT_EQ(0, stat("test.db", &after));
+  EXPECT_EQ(before.st_size, after.st_size);
+  EXPECT_LT(after.st_blocks, before.st_blocks);
+  disk_manager->ReadPage(130, page.data());
+  EXPECT_EQ(0, page[0]);
+  delete disk_manager;
+
+  // allocation state survives a restart
+  disk_manager = new DiskManager("test.db");
+  EXPECT_EQ(100, disk_manager->AllocatePage());
+  for (page_id_t page_id = 101; page_id < 164; ++page_id)
+    EXPECT_EQ(page_id, disk_manager->AllocatePage());
+  EXPECT_EQ(4101, disk_manager->AllocatePage());
+  disk_manager->ReadPage(4095, page.data());
+  EXPECT_TRUE(IsNumberedPage(4095, page.data()));
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, ExtentAllocationTest) {
+  remove("test.db");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(4, disk_manager);
+  // two objects growing at the same time, named by their first page
+  page_id_t first[2];
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(first[i]));
+    bpm->UnpinPage(first[i], true);
+  }
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      page_id_t temp_page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(temp_page_id, nullptr, first[j]));
+      EXPECT_EQ((j + 1) * EXTENT_PAGES + i, temp_page_id);
+      bpm->UnpinPage(temp_page_id, true);
+    }
+  }
+  // a page freed in an extent goes back to its owner
+  EXPECT_TRUE(bpm->DeletePage(EXTENT_PAGES + 3));
+  EXPECT_EQ(EXTENT_PAGES + 3, disk_manager->AllocatePage(first[0]));
+  // other pages stay out of the reserved extents
+  for (page_id_t page_id = 2; page_id < EXTENT_PAGES; ++page_id)
+    EXPECT_EQ(page_id, disk_manager->AllocatePage());
+  EXPECT_EQ(3 * EXTENT_PAGES, disk_manager->AllocatePage());
+  // a full extent is followed by a new one
+  for (int i = 10; i < EXTENT_PAGES; ++i)
+    EXPECT_EQ(2 * EXTENT_PAGES + i, disk_manager->AllocatePage(first[1]));
+  EXPECT_EQ(4 * EXTENT_PAGES, disk_manager->AllocatePage(first[1]));
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, PageChecksumTest) {
+  remove("test.db");
+  DiskManager *disk_manager = new DiskManager("test.db", 512);
+  BufferPoolManager *bpm = new BufferPoolManager(4, disk_manager);
+  EXPECT_EQ(508u, bpm->GetPageDataSize());
+  WriteNumberedPages(bpm, 2);
+  delete bpm;
+
+  std::vector<char> data(512);
+  EXPECT_TRUE(disk_manager->ReadPage(1, data.data()));
+  EXPECT_TRUE(IsNumberedPage(1, data.data()));
+  // pages never written have no checksum
+  EXPECT_TRUE(disk_manager->ReadPage(2, data.data()));
+  // the checksum goes to disk only, the buffer written is left alone
+  std::vector<char> filled(512, 'x');
+  disk_manager->WritePage(2, filled.data());
+  EXPECT_EQ(std::vector<char>(512, 'x'), filled);
+  EXPECT_TRUE(disk_manager->ReadPage(2, data.data()));
+  EXPECT_EQ('x', data[507]);
+  EXPECT_NE('x', data[508]);
+  delete disk_manager;
+
+  // flip one bit of page 1, behind the file header and bitmap page
+  int fd = open("test.db", O_RDWR);
+  ASSERT_GE(fd, 0);
+  char c;
+  ASSERT_EQ(1, pread(fd, &c, 1, 3 * 512 + 100));
+  c ^= 0x10;
+  ASSERT_EQ(1, pwrite(fd, &c, 1, 3 * 512 + 100));
+  close(fd);
+
+  disk_manager = new DiskManager("test.db");
+  EXPECT_TRUE(disk_manager->HasChecksums());
+  EXPECT_TRUE(disk_manager->ReadPage(0, data.data()));
+  EXPECT_FALSE(disk_manager->ReadPage(1, data.data()));
+  EXPECT_EQ(1u, disk_manager->GetChecksumFailures());
+  EXPECT_EQ(1u, disk_manager->ReadPages(1, 1, data.data()));
+  EXPECT_EQ(2u, disk_manager->GetChecksumFailures());
+  std::promise<bool> read;
+  disk_manager->ReadPageAsync(1, data.data(),
+                              [&read](bool ok) { read.set_value(ok); });
+  EXPECT_FALSE(read.get_future().get());
+  std::vector<char> run(2 * 512);
+  std::vector<bool> valid;
+  EXPECT_EQ(2u, disk_manager->ReadPages(0, 2, run.data(), &valid));
+  EXPECT_EQ(std::vector<bool>({true, false}), valid);
+  EXPECT_EQ(4u, disk_manager->GetChecksumFailures());
+
+  // the corrupt page is never handed out, and its frame is freed again
+  bpm = new BufferPoolManager(2, disk_manager);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(7u, disk_manager->GetChecksumFailures());
+  bpm->PrefetchPage(1);
+  for (int i = 0; i < 200 && disk_manager->GetChecksumFailures() < 8; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(8u, disk_manager->GetChecksumFailures());
+  // both frames can be pinned once the failed prefetch is undone
+  Page *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(IsNumberedPage(0, page->GetData()));
+  Page *other = nullptr;
+  for (int i = 0; i < 200 && other == nullptr; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    other = bpm->FetchPage(2);
+  }
+  EXPECT_NE(nullptr, other);
+  EXPECT_EQ(nullptr, bpm->FetchResidentPage(1));
+  bpm->UnpinPage(0, false);
+  bpm->UnpinPage(2, false);
+  delete bpm;
+
+  disk_manager->SetVerifyChecksums(false);
+  EXPECT_TRUE(disk_manager->ReadPage(1, data.data()));
+  EXPECT_EQ(8u, disk_manager->GetChecksumFailures());
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, UnwrittenPageTest) {
+  remove("test.db");
+  DiskManager *disk_manager = new DiskManager("test.db", 512);
+  BufferPoolManager *bpm = new BufferPoolManager(2, disk_manager);
+  page_id_t page_id;
+  for (page_id_t i = 0; i < 8; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    EXPECT_EQ(i, page_id);
+    bpm->UnpinPage(page_id, false);
+  }
+  // the clean pages were evicted without being written, past the file end
+  Page *page = bpm->FetchPage(5);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(std::vector<char>(508, 0),
+            std::vector<char>(page->GetData(), page->GetData() + 508));
+  bpm->UnpinPage(5, false);
+  EXPECT_EQ(0u, disk_manager->GetChecksumFailures());
+  delete bpm;
+
+  std::vector<char> data(512, 'x');
+  EXPECT_TRUE(disk_manager->ReadPage(7, data.data()));
+  EXPECT_EQ(std::vector<char>(512, 0), data);
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, SyncPolicyTest) {
+  remove("test.db");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  EXPECT_EQ(SyncPolicy::CHECKPOINT, disk_manager->GetSyncPolicy());
+  BufferPoolManager *bpm = new BufferPoolManager(4, disk_manager);
+  // evictions are not synced, the flush syncs them together with its pages
+  page_id_t temp_page_id;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(temp_page_id));
+    bpm->UnpinPage(temp_page_id, true);
+  }
+  EXPECT_EQ(0u, disk_manager->GetNumSyncs());
+  EXPECT_EQ(4u, bpm->FlushAllPages());
+  EXPECT_EQ(1u, disk_manager->GetNumSyncs());
+  // nothing written since
+  EXPECT_EQ(0u, bpm->FlushAllPages());
+  EXPECT_EQ(1u, disk_manager->GetNumSyncs());
+  auto page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  bpm->UnpinPage(0, true);
+  bpm->FlushPage(0);
+  EXPECT_EQ(1u, disk_manager->GetNumSyncs());
+  EXPECT_EQ(0u, bpm->FlushAllPages());
+  EXPECT_EQ(2u, disk_manager->GetNumSyncs());
+
+  disk_manager->SetSyncPolicy(SyncPolicy::PER_WRITE);
+  std::vector<char> data(PAGE_SIZE);
+  disk_manager->WritePage(0, data.data());
+  EXPECT_EQ(3u, disk_manager->GetNumSyncs());
+  disk_manager->WritePages(1, {data.data(), data.data()});
+  EXPECT_EQ(4u, disk_manager->GetNumSyncs());
+  std::promise<bool> written;
+  disk_manager->WritePageAsync(
+      3, data.data(), [&written](bool ok) { written.set_value(ok); });
+  EXPECT_TRUE(written.get_future().get());
+  EXPECT_EQ(5u, disk_manager->GetNumSyncs());
+  disk_manager->SyncPages();
+  EXPECT_EQ(5u, disk_manager->GetNumSyncs());
+
+  disk_manager->SetSyncPolicy(SyncPolicy::OS);
+  disk_manager->WritePage(0, data.data());
+  disk_manager->SyncPages();
+  EXPECT_EQ(5u, disk_manager->GetNumSyncs());
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(DiskManagerTest, ReadOnlyMmapTest) {
+  remove("test.db");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(4, disk_manager);
+  WriteNumberedPages(bpm, 10);
+  delete bpm;
+  delete disk_manager;
+
+  disk_manager = new DiskManager("test.db", 0, 0, false, true);
+  EXPECT_TRUE(disk_manager->IsReadOnly());
+  EXPECT_TRUE(disk_manager->IsMapped());
+  bpm = new BufferPoolManager(4, disk_manager);
+  disk_manager->AdviseSequential(0, 10);
+  for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+    auto page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(IsNumberedPage(page_id, page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+  std::vector<char> data(3 * PAGE_SIZE);
+  EXPECT_EQ(3u, disk_manager->ReadPages(4, 3, data.data()));
+  EXPECT_TRUE(IsNumberedPage(6, &data[2 * PAGE_SIZE]));
+  std::promise<bool> read;
+  disk_manager->ReadPageAsync(7, data.data(),
+                              [&read](bool ok) { read.set_value(ok); });
+  EXPECT_TRUE(read.get_future().get());
+  EXPECT_TRUE(IsNumberedPage(7, data.data()));
+
+  // nothing can be changed
+  page_id_t temp_page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(temp_page_id));
+  EXPECT_EQ(INVALID_PAGE_ID, temp_page_id);
+  strcpy(data.data(), "changed");
+  EXPECT_FALSE(disk_manager->WritePage(7, data.data()));
+  EXPECT_FALSE(disk_manager->WritePages(7, {data.data()}));
+  EXPECT_TRUE(disk_manager->ReadPage(7, data.data()));
+  EXPECT_TRUE(IsNumberedPage(7, data.data()));
+  // a page that cannot be written back stays dirty
+  auto page = bpm->FetchPage(7);
+  ASSERT_NE(nullptr, page);
+  strcpy(page->GetData(), "changed");
+  bpm->UnpinPage(7, true);
+  EXPECT_FALSE(bpm->FlushPage(7));
+  EXPECT_EQ(0u, bpm->FlushAllPages());
+  EXPECT_EQ(0.25, bpm->GetDirtyRatio(0));
+  // the background writer tries, and counts nothing written
+  uint64_t writes = bpm->GetStats().write_latency_.count_;
+  bpm->RunBackgroundWriter(4, std::chrono::milliseconds(10), 0);
+  for (int i = 0; i < 200 && bpm->GetStats().write_latency_.count_ == writes;
+       ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  bpm->StopBackgroundWriter();
+  EXPECT_LT(writes, bpm->GetStats().write_latency_.count_);
+  EXPECT_EQ(0u, bpm->GetWriteBackCount(0));
+  EXPECT_EQ(0.25, bpm->GetDirtyRatio(0));
+  page = bpm->FetchPage(7);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp("changed", page->GetData()));
+  bpm->UnpinPage(7, false);
+  // nor is it evicted: the miss that picks it as victim fails, the next one
+  // takes another frame
+  for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPage(3));
+  EXPECT_EQ(0u, bpm->GetStats().Get(BufferPoolEvent::DIRTY_EVICTION));
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  bpm->UnpinPage(3, false);
+  EXPECT_EQ(0.25, bpm->GetDirtyRatio(0));
+  size_t misses = bpm->GetMissCount(0);
+  page = bpm->FetchPage(7);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(misses, bpm->GetMissCount(0));
+  EXPECT_EQ(0, strcmp("changed", page->GetData()));
+  bpm->UnpinPage(7, false);
+  delete bpm;
+  delete disk_manager;
+
+  // and nothing is created
+  disk_manager = new DiskManager("missing.db", 0, 0, false, true);
+  EXPECT_FALSE(disk_manager->IsMapped());
+  delete disk_manager;
+  struct stat buffer;
+  EXPECT_NE(0, stat("missing.db", &buffer));
+  remove("test.db");
+  remove("test.log");
+}
+
+} // namespace cmudb
@@ -0,0 +1,94 @@
+/**
+ * linear_probe_hash_table_test.cpp
+ */
+
+#include <atomic>
+#include <thread>
+
+#include "hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace cmudb {
+
+TEST(LinearProbeHashTableTest, SampleTest) {
+  LinearProbeHashTable<int, int> *test =
+      new LinearProbeHashTable<int, int>(100, -1);
+  EXPECT_EQ(256, test->GetCapacity());
+
+  // insert several key/value pairs
+  for (int i = 0; i < 100; i++) {
+    test->Insert(i, i * 10);
+  }
+  EXPECT_EQ(100, test->GetSize());
+
+  // find test
+  int result;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(1, test->Find(i, result));
+    EXPECT_EQ(i * 10, result);
+  }
+  EXPECT_EQ(0, test->Find(100, result));
+
+  // delete test, every remaining key stays reachable
+  for (int i = 0; i < 100; i += 3) {
+    EXPECT_EQ(1, test->Remove(i));
+  }
+  EXPECT_EQ(0, test->Remove(0));
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(i % 3 != 0, test->Find(i, result));
+  }
+
+  // insert/remove cycles do not leave anything behind
+  for (int round = 0; round < 50; round++) {
+    for (int i = 1000; i < 1030; i++)
+      test->Insert(i, i);
+    for (int i = 1000; i < 1030; i++)
+      EXPECT_EQ(1, test->Remove(i));
+  }
+  EXPECT_EQ(66, test->GetSize());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(i % 3 != 0, test->Find(i, result));
+  }
+
+  delete test;
+}
+
+TEST(LinearProbeHashTableTest, ConcurrentReadTest) {
+  LinearProbeHashTable<int, int> test(64, -1);
+  for (int i = 0; i < 32; i++) {
+    test.Insert(i, i);
+  }
+  // readers run while a single writer keeps inserting and removing other
+  // keys; a lookup may race with a slot being reused, so it can only tell
+  // that the value belongs to some key of the table
+  std::atomic<bool> done(false);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.push_back(std::thread([&test, &done]() {
+      int result;
+      while (!done) {
+        for (int i = 0; i < 32; i++) {
+          if (test.Find(i, result)) {
+            EXPECT_TRUE(result == i || result >= 1100);
+          }
+        }
+      }
+    }));
+  }
+  for (int round = 0; round < 2000; round++) {
+    for (int i = 100; i < 120; i++)
+      test.Insert(i, i + 1000);
+    for (int i = 100; i < 120; i++)
+      test.Remove(i);
+  }
+  done = true;
+  for (auto &reader : readers)
+    reader.join();
+  int result;
+  for (int i = 0; i < 32; i++) {
+    EXPECT_EQ(1, test.Find(i, result));
+    EXPECT_EQ(i, result);
+  }
+}
+
+} // namespace cmudb
@@ -124,4 +124,31 @@ TEST(LogManagerTest, RedoTestWithOneTxn) {
   remove("test.log");
 }
 
+TEST(LogManagerTest, ForceFlushWithoutFlushThread) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  LogManager *log_manager = new LogManager(disk_manager);
+  ENABLE_LOGGING = true;
+  log_manager->SetPersistentLSN(5);
+  EXPECT_TRUE(log_manager->ForceFlush(5));
+
+  // nothing will flush the log, the force gives up instead of blocking
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(log_manager->ForceFlush(10));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 2 * LOG_TIMEOUT);
+
+  // unless the log gets there meanwhile
+  std::thread flusher([log_manager] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    log_manager->SetPersistentLSN(10);
+  });
+  EXPECT_TRUE(log_manager->ForceFlush(10));
+  flusher.join();
+  ENABLE_LOGGING = false;
+
+  delete log_manager;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
 } // namespace cmudb
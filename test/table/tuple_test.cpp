@@ -3,9 +3,11 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -61,4 +63,185 @@ TEST(TupleTest, TableHeapTest) {
   delete disk_manager;
 }
 
+TEST(TupleTest, SequentialScanTest) {
+  std::string createStmt = "a varchar, b smallint, c bigint";
+  Schema *schema = ParseCreateStatement(createStmt);
+  Tuple tuple = ConstructTuple(schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(20, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+
+  // many more heap pages than frames, so the scan has to read them back
+  RID rid;
+  for (int i = 0; i < 2000; ++i)
+    EXPECT_TRUE(table->InsertTuple(tuple, rid, transaction));
+  EXPECT_LT(40, rid.GetPageId());
+
+  // without read-ahead every page is read by the scan itself
+  table->SetReadAheadWindow(0);
+  int count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+    count++;
+  EXPECT_EQ(2000, count);
+  EXPECT_EQ(0, buffer_pool_manager->GetPrefetchCount(0));
+
+  // the scan sees the same tuples while pages are hinted ahead of it
+  table->SetReadAheadWindow(TABLE_READ_AHEAD_PAGES);
+  count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+    count++;
+  EXPECT_EQ(2000, count);
+
+  // and while it is confined to a buffer ring
+  auto strategy = buffer_pool_manager->NewAccessStrategy();
+  count = 0;
+  for (auto itr = table->begin(transaction, strategy); itr != table->end();
+       ++itr)
+    count++;
+  EXPECT_EQ(2000, count);
+
+  // the window fills ahead of a scan that does not move, as every page read
+  // hints the page it links to. In a new pool no hint of the scans above is
+  // left and only the first page is resident, so exactly the window's pages
+  // get prefetched, however long their reads take
+  page_id_t first_page_id = table->GetFirstPageId();
+  buffer_pool_manager->FlushAllPages();
+  delete table;
+  delete buffer_pool_manager;
+  buffer_pool_manager = new BufferPoolManager(20, disk_manager);
+  table = new TableHeap(buffer_pool_manager, lock_manager, log_manager,
+                        first_page_id);
+  {
+    auto itr = table->begin(transaction);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (buffer_pool_manager->GetPrefetchCount(0) < TABLE_READ_AHEAD_PAGES &&
+           std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(TABLE_READ_AHEAD_PAGES, buffer_pool_manager->GetPrefetchCount(0));
+  }
+
+  remove("test.db");
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete transaction;
+  delete lock_manager;
+  delete log_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, ScanResistanceTest) {
+  std::string createStmt = "a varchar, b smallint, c bigint";
+  Schema *schema = ParseCreateStatement(createStmt);
+  Tuple tuple = ConstructTuple(schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(20, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+  RID rid;
+  for (int i = 0; i < 2000; ++i)
+    EXPECT_TRUE(table->InsertTuple(tuple, rid, transaction));
+  page_id_t first_page_id = table->GetFirstPageId();
+  buffer_pool_manager->FlushAllPages();
+  delete table;
+  delete buffer_pool_manager;
+
+  // a scan pins its page once per tuple, which LRU-K and ARC count as one
+  // access: the scan goes through many more pages than frames without
+  // evicting a page used twice
+  for (ReplacerType type : {ReplacerType::LRU_K, ReplacerType::ARC}) {
+    buffer_pool_manager =
+        new BufferPoolManager(20, disk_manager, nullptr, 1, type);
+    table = new TableHeap(buffer_pool_manager, lock_manager, log_manager,
+                          first_page_id);
+    table->SetReadAheadWindow(0);
+    page_id_t hot;
+    ASSERT_NE(nullptr, buffer_pool_manager->NewPage(hot));
+    EXPECT_TRUE(buffer_pool_manager->UnpinPage(hot, true));
+    for (int i = 0; i < CORRELATED_REFERENCE_PERIOD; ++i) {
+      ASSERT_NE(nullptr, buffer_pool_manager->FetchPage(first_page_id));
+      EXPECT_TRUE(buffer_pool_manager->UnpinPage(first_page_id, false));
+    }
+    ASSERT_NE(nullptr, buffer_pool_manager->FetchPage(hot));
+    EXPECT_TRUE(buffer_pool_manager->UnpinPage(hot, false));
+
+    int count = 0;
+    for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+      count++;
+    EXPECT_EQ(2000, count);
+    EXPECT_NE(nullptr, buffer_pool_manager->FetchResidentPage(hot));
+    buffer_pool_manager->UnpinPage(hot, false);
+    delete table;
+    delete buffer_pool_manager;
+  }
+
+  remove("test.db");
+  remove("test.log");
+  delete schema;
+  delete transaction;
+  delete lock_manager;
+  delete log_manager;
+  delete disk_manager;
+}
+
+TEST(TupleTest, ReadOnlyScanTest) {
+  std::string createStmt = "a varchar, b smallint, c bigint";
+  Schema *schema = ParseCreateStatement(createStmt);
+  Tuple tuple = ConstructTuple(schema);
+
+  Transaction *transaction = new Transaction(0);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *buffer_pool_manager =
+      new BufferPoolManager(20, disk_manager);
+  LockManager *lock_manager = new LockManager(true);
+  LogManager *log_manager = new LogManager(disk_manager);
+  TableHeap *table = new TableHeap(buffer_pool_manager, lock_manager,
+                                   log_manager, transaction);
+  RID rid;
+  for (int i = 0; i < 2000; ++i)
+    EXPECT_TRUE(table->InsertTuple(tuple, rid, transaction));
+  page_id_t first_page_id = table->GetFirstPageId();
+  buffer_pool_manager->FlushAllPages();
+  delete table;
+  delete log_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+
+  // the read-ahead of a scan over the mapped file advises the mapping
+  disk_manager = new DiskManager("test.db", 0, 0, false, true);
+  EXPECT_TRUE(disk_manager->IsMapped());
+  buffer_pool_manager = new BufferPoolManager(20, disk_manager);
+  log_manager = new LogManager(disk_manager);
+  table = new TableHeap(buffer_pool_manager, lock_manager, log_manager,
+                        first_page_id);
+  EXPECT_EQ(0, disk_manager->GetNumAdvisedPages());
+  int count = 0;
+  for (auto itr = table->begin(transaction); itr != table->end(); ++itr)
+    count++;
+  EXPECT_EQ(2000, count);
+  EXPECT_LT(0, disk_manager->GetNumAdvisedPages());
+
+  remove("test.db");
+  remove("test.log");
+  delete schema;
+  delete table;
+  delete buffer_pool_manager;
+  delete transaction;
+  delete lock_manager;
+  delete log_manager;
+  delete disk_manager;
+}
+
 } // namespace cmudb
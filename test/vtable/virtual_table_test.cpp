@@ -35,6 +35,15 @@ TEST(VtableTest, CreateTest) {
   EXPECT_TRUE(ExecSQL(db, "SELECT * FROM foo1"));
   EXPECT_TRUE(ExecSQL(db, "DELETE FROM foo1 WHERE b = 2"));
   EXPECT_TRUE(ExecSQL(db, "SELECT * FROM foo1"));
+
+  // buffer pool statistics are readable but not writable
+  EXPECT_TRUE(ExecSQL(db, "SELECT * FROM bpstats"));
+  EXPECT_TRUE(ExecSQL(db, "CREATE VIRTUAL TABLE stats USING bpstats"));
+  EXPECT_TRUE(ExecSQL(db, "SELECT instance, hits, misses, hit_ratio FROM "
+                          "stats WHERE hits > 0"));
+  EXPECT_FALSE(ExecSQL(db, "DELETE FROM stats"));
+  EXPECT_TRUE(ExecSQL(db, "DROP TABLE stats"));
+
   EXPECT_TRUE(ExecSQL(db, "DROP TABLE foo1"));
 
   rc = sqlite3_close(db);
@@ -42,6 +51,7 @@ TEST(VtableTest, CreateTest) {
 
   remove(db_file.c_str());
   remove("vtable.db");
+  remove("vtable.warm");
   return;
 }
 } // namespace cmudb